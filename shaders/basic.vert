@@ -1,17 +1,26 @@
 #version 330 core
-layout (location = 0) in vec3 pos;
+layout (location = 0) in vec3 pos;       // times POSITION_SCALE, packed as bytes
 layout (location = 1) in vec2 tex_coord_in;
-layout (location = 2) in float colour_in;
+layout (location = 2) in uint colour_in;
 
 out vec2 tex_coord;
-out float colour;
+flat out uint colour;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// projection * view * model, multiplied once per draw on the CPU and streamed into a new buffer range every frame
+layout (std140, row_major) uniform Frame {
+	mat4 mvp;
+};
+
+// Rotation of each cubie about the cube centre. Matrices are uploaded row major, like the mat4 uniforms
+layout (std140, row_major) uniform Cubies {
+	mat4 cubie_transform[26];
+};
+
+const int VERTICES_PER_CUBIE = 24;
+const float POSITION_SCALE = 2.0; // CUBE_POSITION_SCALE in cube.h
 
 void main() {
-	gl_Position = projection * view * model * vec4(pos, 1.0);
+	gl_Position = mvp * cubie_transform[gl_VertexID / VERTICES_PER_CUBIE] * vec4(pos / POSITION_SCALE, 1.0);
 	tex_coord = tex_coord_in;
 	colour = colour_in;
-}
\ No newline at end of file
+}
@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 pos;       // times POSITION_SCALE, packed as bytes
+layout (location = 1) in vec2 tex_coord_in;
+layout (location = 2) in uint colour_in;
+
+out vec2 tex_coord;
+flat out uint colour;
+
+// basic.vert without the cubie transforms, used while every cubie is in place
+layout (std140, row_major) uniform Frame {
+	mat4 mvp;
+};
+
+const float POSITION_SCALE = 2.0; // CUBE_POSITION_SCALE in cube.h
+
+void main() {
+	gl_Position = mvp * vec4(pos / POSITION_SCALE, 1.0);
+	tex_coord = tex_coord_in;
+	colour = colour_in;
+}
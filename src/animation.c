@@ -0,0 +1,91 @@
+#include "animation.h"
+
+#include "cube.h"
+#include "matrix.h"
+#include "quaternion.h"
+
+#define QUARTER_TURN 1.57079632679f
+
+static uint8_t queue[ANIMATION_QUEUE_CAPACITY];
+static size_t queue_head = 0;       // next move to play
+static size_t queue_count = 0;
+
+// Turn in progress
+static int turning = 0;
+static uint8_t move;
+static uint64_t elapsed_ns, duration_ns;
+static vec3 axis;                   // model space
+static float final_angle;           // radians, counter-clockwise about axis
+static int layer_cubies[NUM_CUBES];
+static int num_layer_cubies;
+
+int animation_queue(const uint8_t *moves, size_t count) {
+    if (count > ANIMATION_QUEUE_CAPACITY - queue_count) return 0;
+    for (size_t i = 0; i < count; i++) queue[(queue_head + queue_count + i) % ANIMATION_QUEUE_CAPACITY] = moves[i];
+    queue_count += count;
+    return 1;
+}
+
+size_t animation_pending() {
+    return queue_count + (size_t)turning;
+}
+
+void animation_final_state(cube_state *state) {
+    *state = *cube_logical_state();
+    if (turning) cube_state_apply_move(state, move);
+    for (size_t i = 0; i < queue_count; i++) cube_state_apply_move(state, queue[(queue_head + i) % ANIMATION_QUEUE_CAPACITY]);
+}
+
+// Picks the cubies and axis of the next queued move, sharing out the time so the queue drains faster the longer it is
+static void start_turn() {
+    move = queue[queue_head];
+    queue_head = (queue_head + 1) % ANIMATION_QUEUE_CAPACITY;
+    queue_count--;
+    turning = 1;
+
+    duration_ns = ANIMATION_TURN_NS / (1 + queue_count);
+    if (duration_ns < ANIMATION_MIN_TURN_NS) duration_ns = ANIMATION_MIN_TURN_NS;
+
+    int normal[3], min_depth, max_depth;
+    cube_state_move_layers(move, normal, &min_depth, &max_depth);
+    cube_frame_to_world(normal, axis);
+
+    // Clockwise seen from outside is clockwise about the outward normal, a negative angle
+    int power = MOVE_POWER(move);
+    final_angle = (power == 3) ? QUARTER_TURN : -QUARTER_TURN * (float)power;
+
+    num_layer_cubies = 0;
+    for (int i = 0; i < NUM_CUBES; i++) {
+        int position[3];
+        cube_cubie_position(i, position);
+        int depth = position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2];
+        if ((depth >= min_depth) && (depth <= max_depth)) layer_cubies[num_layer_cubies++] = i;
+    }
+}
+
+void animation_update(uint64_t step_ns) {
+    if (!turning && (queue_count == 0)) return;
+    if (!turning) {
+        start_turn();
+        elapsed_ns = 0;
+    }
+
+    elapsed_ns += step_ns;
+    while (elapsed_ns >= duration_ns) {
+        // Time left over goes to the next turn, so playback speed doesn't depend on the step length
+        cube_commit_move(move);
+        elapsed_ns -= duration_ns;
+        turning = 0;
+        if (queue_count == 0) return;
+        start_turn();
+    }
+
+    // Smoothstep, starting and ending the turn at rest
+    float t = (float)elapsed_ns / (float)duration_ns;
+    float eased = t * t * (3.f - 2.f * t);
+
+    // quaternion_create takes half the angle of the rotation it makes
+    mat4 rotation;
+    quaternion_mat(quaternion_create(axis, eased * final_angle / 2), rotation);
+    for (int i = 0; i < num_layer_cubies; i++) cube_set_cubie_transform(layer_cubies[i], rotation);
+}
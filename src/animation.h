@@ -0,0 +1,39 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cube_state.h"
+#include "timer.h"
+
+#define ANIMATION_QUEUE_CAPACITY 256
+#define ANIMATION_TURN_NS (150 * NS_PER_MS)         // a turn with nothing queued behind it
+#define ANIMATION_MIN_TURN_NS (25 * NS_PER_MS)      // a turn with a long queue behind it, 40 turns per second
+
+/*
+* Queue of moves played as layer turns on the simulation thread. The turning cubies rotate about the layer's axis
+* with an ease-in-out curve, then the move is committed to the cube's logical state, which repaints the stickers and
+* puts the cubies back in place. Turns speed up while moves are waiting, so long sequences keep up.
+*/
+
+/*
+* animation_queue: Appends moves to play after those already queued
+*
+* @param[in] moves: move codes, any of NUM_MOVES
+* @param[in] count: number of moves
+*
+* @return 1 if queued, 0 if they don't all fit, in which case none are queued
+*/
+int animation_queue(const uint8_t *moves, size_t count);
+
+// Moves queued or turning
+size_t animation_pending();
+
+// The cube's logical state once every queued move has been played
+void animation_final_state(cube_state *state);
+
+// Advances the turning layer by one simulation step, committing it and starting the next move when it completes
+void animation_update(uint64_t step_ns);
+
+#endif // !ANIMATION_H
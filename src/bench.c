@@ -0,0 +1,594 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "timer.h"
+#include "stats.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "cube.h"
+#include "ray.h"
+#include "read_file.h"
+#include "moves.h"
+#include "cube_state.h"
+#include "rng.h"
+#include "scramble.h"
+#include "two_phase.h"
+#include "coordinates.h"
+#include "pruning_table.h"
+#include "korf.h"
+#include "symmetry.h"
+#include "pocket.h"
+#include "transposition_table.h"
+#include "cl_kernels.h"
+#include "cl_kernels_init.h"
+
+/*
+* Headless micro-benchmarks for the core libraries. Every benchmark is warmed up, calibrated so one repetition
+* runs for at least MIN_REPETITION_NS, then timed over a number of repetitions. Results go to stdout as JSON
+* (ns/op min, median, mean), progress to stderr. A benchmark that stops early (missing file, failed allocation) is
+* left out of the results and reported as failed, and the exit status is then non-zero.
+*
+* usage: rubix_bench [--repetitions N] [--filter SUBSTRING] [--output FILE] [--tables DIR]
+*
+* With --tables the solvers map their tables from DIR (generating them there the first time) instead of building
+* them in memory, which for the optimal solver takes the better part of a minute per core.
+*/
+
+#define DEFAULT_REPETITIONS 15
+#define MIN_REPETITION_NS (20 * NS_PER_MS)
+#define MAX_REPETITIONS 1000
+
+// Calibration stops doubling here, whatever the timing, so an operation the optimizer removed can't loop forever
+#define MAX_ITERATIONS (1ull << 40)
+
+// 100 moves in the usual solve-log form, mixing every notation the parser accepts
+#define BENCH_SEQUENCE \
+    "R U R' U' R' F R2 U' R' U' R U R' F' D2 L' B2 Rw2 u' M2 E S' x y2 z' " \
+    "F2 R2 D' B L2 U2 F' D R' B' U L' D2 F R2 B U2 L D' R' F2 U' B2 l d2 " \
+    "(R U2 R') (U' R U' R') f R U R' U' f' M' U M U2 M' U M Lw' U2 L U L' " \
+    "U2 R U R' U R U2 R' y' R' U' R U R' F' R U R' U' R' F R2 U' R' U2 x2"
+
+#ifndef BENCH_READ_FILE
+#define BENCH_READ_FILE "../shaders/basic.vert"
+#endif
+
+// Runs the benchmarked operation `iterations` times, returns 0 if it had to stop early
+typedef int (*bench_fn)(uint64_t iterations);
+
+typedef struct {
+    const char *name;
+    bench_fn fn;
+    int (*available)();     // checked before running, NULL if the benchmark can always run
+} benchmark;
+
+typedef struct {
+    const char *name;
+    uint64_t iterations;
+    int repetitions;
+    double min_ns;
+    double median_ns;
+    double mean_ns;
+} bench_result;
+
+// Results are folded in here so the compiler can't drop the benchmarked work
+static volatile float sink;
+
+// Where the solvers keep their tables, NULL to build them in memory
+static const char *table_dir = NULL;
+
+// -------------------------- Benchmarks --------------------------------
+
+static int bench_mat_mul(uint64_t iterations) {
+    mat4 a, b, c;
+    quaternion_mat(quaternion_create((vec3) { 1, 2, 3 }, 0.3f), a);
+    translation_mat((vec3) { 1, -2, 3 }, b);
+    for (uint64_t i = 0; i < iterations; i++) {
+        mat_mul(a, b, c);
+        a[3] = c[5]; // serialize iterations
+    }
+    sink = c[0];
+    return 1;
+}
+
+static int bench_mat_inverse(uint64_t iterations) {
+    mat4 m, base;
+    quaternion_mat(quaternion_create((vec3) { 1, 2, 3 }, 0.3f), base);
+    base[3] = 1.f; base[7] = -2.f; base[11] = 3.f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        mat_copy(m, base);
+        mat_inverse(m);
+        base[3] = 1.f + m[15] * 1e-9f;
+    }
+    sink = m[0];
+    return 1;
+}
+
+static int bench_quaternion_mul(uint64_t iterations) {
+    quaternion q = quaternion_create((vec3) { 0, 1, 0 }, 0.f);
+    quaternion step = quaternion_create((vec3) { 1, 2, 3 }, 0.01f);
+    for (uint64_t i = 0; i < iterations; i++) q = quaternion_mul(step, q);
+    sink = q.s;
+    return 1;
+}
+
+static int bench_quaternion_mat(uint64_t iterations) {
+    quaternion q = quaternion_create((vec3) { 1, 2, 3 }, 0.3f);
+    mat4 m;
+    for (uint64_t i = 0; i < iterations; i++) {
+        quaternion_mat(q, m);
+        q.s = m[0] * 1e-9f + 0.5f;
+    }
+    sink = m[0];
+    return 1;
+}
+
+static int bench_quaternion_create(uint64_t iterations) {
+    quaternion q;
+    float angle = 0.f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        q = quaternion_create((vec3) { 1, 2, 3 }, angle);
+        angle += q.s * 1e-6f;
+    }
+    sink = angle;
+    return 1;
+}
+
+static int bench_cube_mesh(uint64_t iterations) {
+    int size;
+    for (uint64_t i = 0; i < iterations; i++) cube_init_data();
+    sink = cube_vertex_info(&size)[0].position[0];
+    return 1;
+}
+
+static int bench_pick(uint64_t iterations) {
+    int vertices_size, indices_size;
+    cube_init_data();
+    const cube_vertex *packed = cube_vertex_info(&vertices_size);
+    const unsigned short *indices = cube_index_info(&indices_size);
+    int index_count = indices_size / (int)sizeof(unsigned short);
+
+    // Picking works on float positions, unpacked once like a caller keeping a CPU side copy would
+    int vertex_count = vertices_size / (int)sizeof(cube_vertex);
+    float *vertices = malloc((size_t)vertex_count * 3 * sizeof(float));
+    if (vertices == NULL) return 0;
+    for (int i = 0; i < vertex_count * 3; i++) vertices[i] = (float)packed[i / 3].position[i % 3] / CUBE_POSITION_SCALE;
+
+    // From the default camera position towards the cube, sweeping across its front
+    ray r = { { 0, 5, -10 }, { 0, -5, 10 } };
+    float t = 0, total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        r.direction[0] = (float)(i % 64) / 32.f - 1.f;
+        if (ray_pick(r, vertices, indices, index_count, &t) >= 0) total += t;
+    }
+    sink = total;
+    free(vertices);
+    return 1;
+}
+
+static int bench_read_file(uint64_t iterations) {
+    size_t total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        char *contents = read_file(BENCH_READ_FILE);
+        if (contents == NULL) return 0;
+        total += strlen(contents);
+        free(contents);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+static int bench_moves_parse(uint64_t iterations) {
+    uint8_t moves[256];
+    size_t total = 0;
+    for (uint64_t i = 0; i < iterations; i++) total += (size_t)moves_parse(BENCH_SEQUENCE, sizeof(BENCH_SEQUENCE) - 1, moves, 256, NULL);
+    sink = (float)total;
+    return 1;
+}
+
+static int bench_cube_state_apply(uint64_t iterations) {
+    uint8_t moves[256];
+    long count = moves_parse(BENCH_SEQUENCE, sizeof(BENCH_SEQUENCE) - 1, moves, 256, NULL);
+    cube_state state;
+    cube_state_solved(&state);
+    for (uint64_t i = 0; i < iterations; i++) cube_state_apply_moves(&state, moves, (size_t)count);
+    sink = state.cp[0];
+    return 1;
+}
+
+static int bench_moves_canonicalise(uint64_t iterations) {
+    uint8_t parsed[256], moves[256];
+    long count = moves_parse(BENCH_SEQUENCE, sizeof(BENCH_SEQUENCE) - 1, parsed, 256, NULL);
+    size_t total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        memcpy(moves, parsed, (size_t)count);
+        total += moves_canonicalise(moves, (size_t)count);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+static int bench_scramble(uint64_t iterations) {
+    rng r;
+    rng_seed(&r, 1);
+    cube_state state;
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        scramble_random_state(&r, &state);
+        total += state.ep[0];
+    }
+    sink = (float)total;
+    return 1;
+}
+
+static int bench_two_phase(uint64_t iterations) {
+    rng r;
+    rng_seed(&r, 1);
+    cube_state state;
+    uint8_t moves[TWO_PHASE_MAX_MOVES];
+    int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        scramble_random_state(&r, &state);
+        total += two_phase_solve(&state, 22, 0, moves);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// Optimal solutions to 12-move random walks, with the search speed on stderr; threads 1 runs the sequential solver
+static int bench_korf_threads(uint64_t iterations, int threads) {
+    rng r;
+    rng_seed(&r, 1);
+    uint8_t moves[KORF_MAX_MOVES];
+    korf_stats stats;
+    uint64_t nodes = 0, elapsed_ns = 0;
+    int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        cube_state state;
+        cube_state_solved(&state);
+        uint8_t walk[12];
+        for (int j = 0; j < 12; j++) {
+            do walk[j] = (uint8_t)rng_below(&r, NUM_FACE_MOVES);
+            while ((j > 0) && move_is_redundant(walk[j - 1], walk[j]));
+        }
+        cube_state_apply_moves(&state, walk, 12);
+        if (threads == 1) total += korf_solve(&state, 12, 0, moves, &stats);
+        else total += korf_solve_parallel(&state, 12, 0, threads, 3, moves, &stats);
+        nodes += stats.nodes;
+        elapsed_ns += stats.elapsed_ns;
+    }
+    if (elapsed_ns) fprintf(stderr, "  korf: %.2f M nodes/s\n", (double)nodes * NS_PER_SEC / (double)elapsed_ns / 1e6);
+    sink = (float)total;
+    return 1;
+}
+
+static int bench_korf(uint64_t iterations) {
+    return bench_korf_threads(iterations, 1);
+}
+
+static int bench_korf_parallel(uint64_t iterations) {
+    return bench_korf_threads(iterations, 0);
+}
+
+// Twist x flip, 4.5M entries, the product both table generators are timed on
+static coord_product twist_flip_product() {
+    static uint16_t twist_move[NUM_TWISTS * NUM_FACE_MOVES], flip_move[NUM_FLIPS * NUM_FACE_MOVES];
+    uint8_t moves[NUM_FACE_MOVES];
+    for (int m = 0; m < NUM_FACE_MOVES; m++) moves[m] = m;
+    coord_move_table(twist_move, NUM_TWISTS, coord_twist, coord_set_twist, moves, NUM_FACE_MOVES);
+    coord_move_table(flip_move, NUM_FLIPS, coord_flip, coord_set_flip, moves, NUM_FACE_MOVES);
+    return (coord_product){ 2, NUM_FACE_MOVES, { NUM_TWISTS, NUM_FLIPS }, { twist_move, flip_move } };
+}
+
+// Builds the twist x flip distance table on all cores, the cold-start cost of table generation
+static int bench_pruning_table(uint64_t iterations) {
+    coord_product product = twist_flip_product();
+    coord_space space;
+    coord_product_space(&product, &space);
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        pruning_table table;
+        if (!pruning_table_generate(&table, &space, 4, 0, NULL)) return 0;
+        total += pruning_table_get(&table, space.size - 1);
+        pruning_table_free(&table);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// The same table built on the OpenCL device
+static int bench_pruning_table_cl(uint64_t iterations) {
+    coord_product product = twist_flip_product();
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        pruning_table table;
+        if (!cl_pruning_table_generate(&table, &product, 4, NULL)) return 0;
+        total += pruning_table_get(&table, table.size - 1);
+        pruning_table_free(&table);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// A batch of random states, each taking its own random walk over every move code, slices and rotations included
+#define CUBE_SIM_BATCH 4096
+#define CUBE_SIM_MAX_WALK 40
+
+static cube_sim_states sim_states;
+static cube_state sim_start[CUBE_SIM_BATCH];
+static uint8_t sim_moves[CUBE_SIM_BATCH * CUBE_SIM_MAX_WALK];
+static uint32_t sim_offsets[CUBE_SIM_BATCH + 1];
+static uint8_t sim_solved[CUBE_SIM_BATCH];
+
+// Every 64th state starts solved and stays put, so the solved flags see both values
+static void cube_sim_batch(rng *r) {
+    uint32_t k = 0;
+    for (int i = 0; i < CUBE_SIM_BATCH; i++) {
+        sim_offsets[i] = k;
+        if (i % 64 == 0) {
+            cube_state_solved(&sim_start[i]);
+            continue;
+        }
+        scramble_random_state(r, &sim_start[i]);
+        uint64_t length = rng_below(r, CUBE_SIM_MAX_WALK + 1);
+        for (uint64_t j = 0; j < length; j++) sim_moves[k++] = (uint8_t)rng_below(r, NUM_MOVES);
+    }
+    sim_offsets[CUBE_SIM_BATCH] = k;
+}
+
+// The whole batch moved on the OpenCL device per iteration, transfers included. States carry on from the last call
+static int bench_cube_sim_cl(uint64_t iterations) {
+    if (sim_states.fields == NULL) return 0;
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!cl_cube_sim_apply(&sim_states, sim_moves, sim_offsets, sim_solved)) return 0;
+        total += sim_solved[0];
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// Classes of phase 1's flip and slice under the 16 U-D symmetries, 1M raw values down to 64430
+static int bench_flipslice_classes(uint64_t iterations) {
+    symmetry_init();
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        sym_coord coord;
+        if (!sym_coord_build(&coord, NUM_FLIPSLICE, coord_flipslice, coord_set_flipslice, NUM_UD_SYMMETRIES)) return 0;
+        total += coord.num_classes;
+        sym_coord_free(&coord);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// Optimal 2x2x2 solutions of random corner arrangements, a walk down the distance table
+static int bench_pocket(uint64_t iterations) {
+    rng r;
+    rng_seed(&r, 1);
+    cube_state state;
+    uint8_t moves[POCKET_MAX_MOVES];
+    int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        scramble_random_state(&r, &state);
+        total += pocket_solve(&state, moves);
+    }
+    sink = (float)total;
+    return 1;
+}
+
+// States along a random walk of face turns, hashed and looked up, and stored when missing
+static int bench_transposition_table(uint64_t iterations) {
+    static transposition_table table;
+    if ((table.slots == NULL) && !transposition_table_init(&table, 1 << 18)) return 0;
+    rng r;
+    rng_seed(&r, 1);
+    cube_state state;
+    cube_state_solved(&state);
+    unsigned int total = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint8_t move = (uint8_t)rng_below(&r, NUM_FACE_MOVES);
+        cube_state_apply_moves(&state, &move, 1);
+        uint64_t key = cube_state_hash(&state);
+        tt_entry entry;
+        if (transposition_table_probe(&table, key, &entry)) total += entry.value;
+        else transposition_table_store(&table, key, (tt_entry){ (uint8_t)(i & 15), move, move, 0 });
+    }
+    sink = (float)total;
+    return 1;
+}
+
+static int two_phase_available() {
+    return two_phase_init(table_dir);
+}
+
+static int pocket_available() {
+    return pocket_init(table_dir);
+}
+
+static int korf_available() {
+    return korf_init(table_dir);
+}
+
+// Both OpenCL benchmarks share one context
+static int opencl_available() {
+    static int initialised = -1;
+    if (initialised < 0) initialised = cl_kernels_init();
+    return initialised;
+}
+
+// Needs a device, and is only timed once its table has matched the host generator's bit for bit
+static int pruning_table_cl_available() {
+    if (!opencl_available()) return 0;
+    coord_product product = twist_flip_product();
+    coord_space space;
+    coord_product_space(&product, &space);
+    pruning_table device, host;
+    if (!cl_pruning_table_generate(&device, &product, 4, NULL)) return 0;
+    if (!pruning_table_generate(&host, &space, 4, 0, NULL)) {
+        pruning_table_free(&device);
+        return 0;
+    }
+    int same = memcmp(device.words, host.words, (size_t)(space.size + 7) / 8 * sizeof(uint32_t)) == 0;
+    if (!same) fprintf(stderr, "  cl_pruning_table_generate doesn't match the host generator\n");
+    pruning_table_free(&host);
+    pruning_table_free(&device);
+    return same;
+}
+
+// Needs the kernel built, and is only timed once a random batch moved on the device matches the host path and
+// cube_state_apply_moves byte for byte
+static int cube_sim_cl_available() {
+    if (!opencl_available() || !cl_cube_sim_available()) return 0;
+    cube_sim_states host;
+    if (!cube_sim_states_alloc(&sim_states, CUBE_SIM_BATCH)) return 0;
+    if (!cube_sim_states_alloc(&host, CUBE_SIM_BATCH)) {
+        cube_sim_states_free(&sim_states);
+        return 0;
+    }
+
+    rng r;
+    rng_seed(&r, 1);
+    cube_sim_batch(&r);
+    for (int i = 0; i < CUBE_SIM_BATCH; i++) {
+        cube_sim_pack(&sim_states, (size_t)i, &sim_start[i]);
+        cube_sim_pack(&host, (size_t)i, &sim_start[i]);
+    }
+    uint8_t host_solved[CUBE_SIM_BATCH];
+    int same = cl_cube_sim_apply(&sim_states, sim_moves, sim_offsets, sim_solved);
+    cube_sim_apply_host(&host, sim_moves, sim_offsets, host_solved);
+    same = same && (memcmp(sim_states.fields, host.fields, (size_t)CUBE_SIM_BATCH * CUBE_SIM_FIELDS) == 0)
+        && (memcmp(sim_solved, host_solved, CUBE_SIM_BATCH) == 0);
+    for (int i = 0; same && (i < CUBE_SIM_BATCH); i++) {
+        cube_state expected = sim_start[i], moved;
+        cube_state_apply_moves(&expected, &sim_moves[sim_offsets[i]], sim_offsets[i + 1] - sim_offsets[i]);
+        cube_sim_unpack(&sim_states, (size_t)i, &moved);
+        same = (memcmp(&moved, &expected, sizeof(cube_state)) == 0) && (sim_solved[i] == cube_state_is_solved(&expected));
+    }
+    if (!same) {
+        fprintf(stderr, "  cl_cube_sim_apply doesn't match the host path and cube_state_apply_moves\n");
+        cube_sim_states_free(&sim_states);
+    }
+    cube_sim_states_free(&host);
+    return same;
+}
+
+static const benchmark benchmarks[] = {
+    { "matrix/mat_mul", bench_mat_mul, NULL },
+    { "matrix/mat_inverse", bench_mat_inverse, NULL },
+    { "quaternion/mul", bench_quaternion_mul, NULL },
+    { "quaternion/to_mat", bench_quaternion_mat, NULL },
+    { "quaternion/create", bench_quaternion_create, NULL },
+    { "cube/mesh_generation", bench_cube_mesh, NULL },
+    { "ray/pick_cube", bench_pick, NULL },
+    { "read_file/shader", bench_read_file, NULL },
+    { "moves/parse_100", bench_moves_parse, NULL },
+    { "moves/canonicalise_100", bench_moves_canonicalise, NULL },
+    { "cube_state/apply_100", bench_cube_state_apply, NULL },
+    { "cube_sim/apply_cl", bench_cube_sim_cl, cube_sim_cl_available },
+    { "scramble/random_state", bench_scramble, NULL },
+    { "two_phase/solve_22", bench_two_phase, two_phase_available },
+    { "pocket/solve", bench_pocket, pocket_available },
+    { "korf/solve_12", bench_korf, korf_available },
+    { "korf/solve_12_parallel", bench_korf_parallel, korf_available },
+    { "symmetry/flipslice_classes", bench_flipslice_classes, NULL },
+    { "transposition_table/probe_store", bench_transposition_table, NULL },
+    { "pruning_table/twist_flip", bench_pruning_table, NULL },
+    { "pruning_table/twist_flip_cl", bench_pruning_table_cl, pruning_table_cl_available },
+};
+
+// -------------------------- Harness -----------------------------------
+
+// Times one batch, 0 if the benchmark stopped early
+static int time_iterations(bench_fn fn, uint64_t iterations, uint64_t *elapsed_ns) {
+    uint64_t start = timer_now_ns();
+    int ok = fn(iterations);
+    *elapsed_ns = timer_now_ns() - start;
+    return ok;
+}
+
+// Fills in result, 0 if the benchmark failed part way and has no meaningful timing
+static int run_benchmark(const benchmark *b, int repetitions, bench_result *result) {
+    // Warm-up doubles as calibration: grow the batch until one repetition is long enough to time reliably
+    uint64_t iterations = 1, elapsed_ns;
+    for (;;) {
+        if (!time_iterations(b->fn, iterations, &elapsed_ns)) return 0;
+        if ((elapsed_ns >= MIN_REPETITION_NS) || (iterations >= MAX_ITERATIONS)) break;
+        iterations *= 2;
+    }
+
+    uint64_t durations[MAX_REPETITIONS];
+    for (int rep = 0; rep < repetitions; rep++) {
+        if (!time_iterations(b->fn, iterations, &durations[rep])) return 0;
+    }
+    sample_summary summary = summarise_samples(durations, (unsigned int)repetitions);
+
+    result->name = b->name;
+    result->iterations = iterations;
+    result->repetitions = repetitions;
+    result->min_ns = (double)summary.min / (double)iterations;
+    result->median_ns = (double)summary.p50 / (double)iterations;
+    result->mean_ns = summary.mean / (double)iterations;
+    return 1;
+}
+
+static void write_json(FILE *out, const bench_result *results, int count) {
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, "
+            "\"min_ns_per_op\": %.3f, \"median_ns_per_op\": %.3f, \"mean_ns_per_op\": %.3f}%s\n",
+            results[i].name, (unsigned long long)results[i].iterations, results[i].repetitions,
+            results[i].min_ns, results[i].median_ns, results[i].mean_ns, (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+    int repetitions = DEFAULT_REPETITIONS;
+    const char *filter = NULL;
+    const char *output = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--repetitions") && (i + 1 < argc)) repetitions = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && (i + 1 < argc)) filter = argv[++i];
+        else if (!strcmp(argv[i], "--output") && (i + 1 < argc)) output = argv[++i];
+        else if (!strcmp(argv[i], "--tables") && (i + 1 < argc)) table_dir = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--repetitions N] [--filter SUBSTRING] [--output FILE] [--tables DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repetitions < 1) repetitions = 1;
+    if (repetitions > MAX_REPETITIONS) repetitions = MAX_REPETITIONS;
+
+    cube_state_init();
+
+    const int num_benchmarks = (int)(sizeof(benchmarks) / sizeof(benchmarks[0]));
+    bench_result results[sizeof(benchmarks) / sizeof(benchmarks[0])];
+    int count = 0, failed = 0;
+    for (int i = 0; i < num_benchmarks; i++) {
+        if (filter && !strstr(benchmarks[i].name, filter)) continue;
+        if (benchmarks[i].available && !benchmarks[i].available()) {
+            fprintf(stderr, "%-28s skipped, not available here\n", benchmarks[i].name);
+            continue;
+        }
+        if (!run_benchmark(&benchmarks[i], repetitions, &results[count])) {
+            fprintf(stderr, "%-28s failed, stopped before finishing its iterations\n", benchmarks[i].name);
+            failed++;
+            continue;
+        }
+        fprintf(stderr, "%-28s %12.2f ns/op (median %.2f)\n", results[count].name, results[count].min_ns, results[count].median_ns);
+        count++;
+    }
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (out == NULL) {
+        perror("rubix_bench");
+        return 1;
+    }
+    write_json(out, results, count);
+    if (output) fclose(out);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,398 @@
+#include "capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <glad/gl.h>
+
+#include "thread.h"
+#include "timer.h"
+
+// Readbacks in flight, frames are collected this many frames after being issued
+#define NUM_PBOS 3
+
+// Frames buffered between the GL thread and the encoder
+#define QUEUE_SIZE 16
+
+typedef enum { FORMAT_PNG, FORMAT_Y4M } capture_format;
+
+static const char *output_path = NULL;
+static int capturing = 0;
+static capture_format format;
+static int cwidth, cheight, cfps;
+static size_t frame_size;
+static uint64_t video_frame_ns;     // length of one video frame
+static uint64_t first_frame_ns;     // when the first captured frame was shown, the start of the video
+
+// Readback ring (GL thread only)
+static unsigned int pbos[NUM_PBOS];
+static GLsync fences[NUM_PBOS];
+static uint64_t shown_ns[NUM_PBOS];
+static unsigned int pbo_next = 0;
+
+// A frame waiting for the encoder, and the video frame it belongs on
+typedef struct {
+    int buffer;
+    uint64_t video_frame;
+} queued_frame;
+
+// Frame queue, buffers move free -> ready (GL thread) -> encoder -> free
+static thread_handle encoder_thread;
+static thread_mutex queue_mutex = THREAD_MUTEX_INITIALIZER;
+static thread_cond queue_cond = THREAD_COND_INITIALIZER;   // a frame is ready, or capture is stopping
+static thread_cond free_cond = THREAD_COND_INITIALIZER;    // a buffer was freed
+static unsigned char *buffers[QUEUE_SIZE];
+static int free_list[QUEUE_SIZE], free_count;
+static queued_frame ready[QUEUE_SIZE];
+static int ready_head, ready_count;
+static int encoder_done;
+
+// Statistics
+static unsigned long frames_issued, frames_written, frames_repeated, encoder_waits, readbacks_failed;
+
+static void collect(unsigned int slot);
+static void *encoder_loop(void *arg);
+static void encode(const unsigned char *rgba, FILE *video, unsigned long video_frame);
+static void write_png(const char *path, const unsigned char *rgba);
+static void write_y4m_frame(FILE *file, const unsigned char *rgba);
+
+void capture_set_output(const char *path) {
+    output_path = path;
+}
+
+int capture_start(int width, int height, int fps) {
+    if (output_path == NULL) return 1;
+
+    size_t length = strlen(output_path);
+    format = (length >= 4 && !strcmp(output_path + length - 4, ".y4m")) ? FORMAT_Y4M : FORMAT_PNG;
+
+    // 4:2:0 chroma subsampling needs even dimensions
+    cwidth = (format == FORMAT_Y4M) ? width & ~1 : width;
+    cheight = (format == FORMAT_Y4M) ? height & ~1 : height;
+    cfps = fps;
+    video_frame_ns = NS_PER_SEC / (uint64_t)fps;
+    frames_issued = frames_written = frames_repeated = encoder_waits = readbacks_failed = 0;
+    frame_size = (size_t)cwidth * cheight * 4;
+
+    free_count = 0;
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        buffers[i] = malloc(frame_size);
+        if (buffers[i] == NULL) return 0;
+        free_list[free_count++] = i;
+    }
+    ready_head = ready_count = 0;
+    encoder_done = 0;
+
+    glGenBuffers(NUM_PBOS, pbos);
+    for (int i = 0; i < NUM_PBOS; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)frame_size, NULL, GL_STREAM_READ);
+        fences[i] = NULL;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!thread_create(&encoder_thread, encoder_loop, NULL)) return 0;
+    capturing = 1;
+    return 1;
+}
+
+int capture_active() {
+    return capturing;
+}
+
+void capture_frame(uint64_t time_ns) {
+    if (!capturing) return;
+    if (frames_issued == 0) first_frame_ns = time_ns;
+
+    // Hand over every readback the GPU has finished, oldest first, without waiting
+    for (unsigned int n = 0; n < NUM_PBOS; n++) {
+        unsigned int slot = (pbo_next + n) % NUM_PBOS;
+        if (fences[slot] == NULL) continue;
+        GLenum status = glClientWaitSync(fences[slot], 0, 0);
+        if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED)) break;
+        collect(slot);
+    }
+
+    // The ring is full only if the GPU is more than NUM_PBOS frames behind, then there's nothing to do but wait
+    if (fences[pbo_next] != NULL) {
+        glClientWaitSync(fences[pbo_next], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+        collect(pbo_next);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo_next]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, cwidth, cheight, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[pbo_next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    shown_ns[pbo_next] = time_ns;
+    pbo_next = (pbo_next + 1) % NUM_PBOS;
+    frames_issued++;
+}
+
+void capture_stop() {
+    if (!capturing) return;
+
+    // Remaining readbacks, in issue order
+    for (unsigned int n = 0; n < NUM_PBOS; n++) {
+        unsigned int slot = (pbo_next + n) % NUM_PBOS;
+        if (fences[slot] == NULL) continue;
+        glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+        collect(slot);
+    }
+    glDeleteBuffers(NUM_PBOS, pbos);
+
+    thread_mutex_lock(&queue_mutex);
+    encoder_done = 1;
+    thread_cond_broadcast(&queue_cond);
+    thread_mutex_unlock(&queue_mutex);
+    thread_join(encoder_thread);
+
+    for (int i = 0; i < QUEUE_SIZE; i++) free(buffers[i]);
+    capturing = 0;
+
+    printf("Captured %lu frames to %s as %lu video frames at %d fps (%lu repeats to cover late frames, "
+        "waited on the encoder %lu times, %lu failed readbacks)\n",
+        frames_issued, output_path, frames_written, cfps, frames_repeated, encoder_waits, readbacks_failed);
+}
+
+/*
+* Copies a finished readback into a free queue buffer and wakes the encoder. Every frame is kept: when the encoder
+* has fallen behind and no buffer is free, this waits for one, holding the display back rather than the video.
+*/
+static void collect(unsigned int slot) {
+    glDeleteSync(fences[slot]);
+    fences[slot] = NULL;
+    uint64_t video_frame = (shown_ns[slot] - first_frame_ns + video_frame_ns / 2) / video_frame_ns;
+
+    thread_mutex_lock(&queue_mutex);
+    if (free_count == 0) {
+        encoder_waits++;
+        while (free_count == 0) thread_cond_wait(&free_cond, &queue_mutex);
+    }
+    int buffer = free_list[--free_count];
+    thread_mutex_unlock(&queue_mutex);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)frame_size, GL_MAP_READ_BIT);
+    if (pixels) {
+        memcpy(buffers[buffer], pixels, frame_size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // A failed readback leaves a gap, which the encoder covers by showing the previous frame for longer
+    thread_mutex_lock(&queue_mutex);
+    if (pixels) {
+        ready[(ready_head + ready_count++) % QUEUE_SIZE] = (queued_frame){ buffer, video_frame };
+        thread_cond_signal(&queue_cond);
+    }
+    else {
+        free_list[free_count++] = buffer;
+        readbacks_failed++;
+    }
+    thread_mutex_unlock(&queue_mutex);
+}
+
+static void *encoder_loop(void *arg) {
+    FILE *video = NULL;
+    if (format == FORMAT_Y4M) {
+        video = fopen(output_path, "wb");
+        if (video == NULL) perror("capture");
+        else fprintf(video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", cwidth, cheight, cfps);
+    }
+
+    /*
+    * Frames land on the video frame matching the time they were shown. Where the display missed a vblank or the
+    * application stalled, the previous frame was still on screen, so it is written again until the next frame is
+    * due. It stays held here until then. A frame shown early still gets its own video frame, none are skipped.
+    */
+    int previous = -1;
+    unsigned long next_frame = 0;
+    for (;;) {
+        thread_mutex_lock(&queue_mutex);
+        while ((ready_count == 0) && !encoder_done) thread_cond_wait(&queue_cond, &queue_mutex);
+        if (ready_count == 0) {
+            thread_mutex_unlock(&queue_mutex);
+            break;
+        }
+        queued_frame next = ready[ready_head];
+        ready_head = (ready_head + 1) % QUEUE_SIZE;
+        ready_count--;
+        thread_mutex_unlock(&queue_mutex);
+
+        if (previous >= 0) {
+            for (; next_frame < next.video_frame; next_frame++, frames_repeated++) encode(buffers[previous], video, next_frame);
+        }
+        encode(buffers[next.buffer], video, next_frame++);
+
+        if (previous >= 0) {
+            thread_mutex_lock(&queue_mutex);
+            free_list[free_count++] = previous;
+            thread_cond_signal(&free_cond);
+            thread_mutex_unlock(&queue_mutex);
+        }
+        previous = next.buffer;
+    }
+    frames_written = next_frame;
+
+    if (previous >= 0) {
+        thread_mutex_lock(&queue_mutex);
+        free_list[free_count++] = previous;
+        thread_mutex_unlock(&queue_mutex);
+    }
+    if (video) fclose(video);
+    return NULL;
+}
+
+static void encode(const unsigned char *rgba, FILE *video, unsigned long video_frame) {
+    if (format == FORMAT_Y4M) {
+        if (video) write_y4m_frame(video, rgba);
+    }
+    else {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s_%05lu.png", output_path, video_frame);
+        write_png(path, rgba);
+    }
+}
+
+// -------------------------- Encoders ----------------------------------
+
+static void write_be32(FILE *file, uint32_t value) {
+    unsigned char bytes[4] = { value >> 24, value >> 16, value >> 8, value };
+    fwrite(bytes, 1, 4, file);
+}
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char *data, size_t length) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void write_chunk(FILE *file, const char *type, const unsigned char *data, size_t length) {
+    write_be32(file, (uint32_t)length);
+    fwrite(type, 1, 4, file);
+    if (length) fwrite(data, 1, length, file);
+    uint32_t crc = crc32_update(0, (const unsigned char *)type, 4);
+    write_be32(file, crc32_update(crc, data, length));
+}
+
+/*
+* write_png: 8 bit RGB PNG. The zlib stream uses stored (uncompressed) deflate blocks, which keeps encoding cheap
+* enough to follow the display frame rate; recompress offline if size matters.
+*/
+static void write_png(const char *path, const unsigned char *rgba) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror("capture");
+        return;
+    }
+
+    // Filter byte + RGB per row, rows top first (GL rows start at the bottom)
+    size_t row_size = 1 + (size_t)cwidth * 3;
+    size_t raw_size = row_size * cheight;
+    size_t num_blocks = (raw_size + 65534) / 65535;
+    size_t zlib_size = 2 + num_blocks * 5 + raw_size + 4;
+    unsigned char *zlib = malloc(zlib_size);
+    unsigned char *raw = malloc(raw_size);
+    if ((zlib == NULL) || (raw == NULL)) {
+        free(zlib);
+        free(raw);
+        fclose(file);
+        return;
+    }
+
+    for (int y = 0; y < cheight; y++) {
+        unsigned char *dst = raw + (size_t)y * row_size;
+        const unsigned char *src = rgba + (size_t)(cheight - 1 - y) * cwidth * 4;
+        *dst++ = 0;
+        for (int x = 0; x < cwidth; x++, src += 4) {
+            *dst++ = src[0];
+            *dst++ = src[1];
+            *dst++ = src[2];
+        }
+    }
+
+    size_t out = 0;
+    zlib[out++] = 0x78;
+    zlib[out++] = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < raw_size; offset += 65535) {
+        size_t length = (raw_size - offset < 65535) ? raw_size - offset : 65535;
+        zlib[out++] = (offset + length == raw_size) ? 1 : 0;
+        zlib[out++] = length & 0xFF;
+        zlib[out++] = (length >> 8) & 0xFF;
+        zlib[out++] = ~length & 0xFF;
+        zlib[out++] = (~length >> 8) & 0xFF;
+        memcpy(zlib + out, raw + offset, length);
+        out += length;
+        for (size_t i = 0; i < length; i++) {
+            a = (a + raw[offset + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    uint32_t adler = (b << 16) | a;
+    zlib[out++] = adler >> 24;
+    zlib[out++] = adler >> 16;
+    zlib[out++] = adler >> 8;
+    zlib[out++] = adler;
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    unsigned char header[13] = {
+        cwidth >> 24, cwidth >> 16, cwidth >> 8, cwidth,
+        cheight >> 24, cheight >> 16, cheight >> 8, cheight,
+        8, 2, 0, 0, 0 // 8 bit, truecolour, deflate, adaptive filtering, no interlace
+    };
+    fwrite(signature, 1, 8, file);
+    write_chunk(file, "IHDR", header, sizeof(header));
+    write_chunk(file, "IDAT", zlib, out);
+    write_chunk(file, "IEND", NULL, 0);
+
+    fclose(file);
+    free(zlib);
+    free(raw);
+}
+
+static unsigned char clamp_byte(int value) {
+    return (unsigned char)((value < 0) ? 0 : (value > 255) ? 255 : value);
+}
+
+// Full range BT.601 (the C420jpeg colour space), chroma averaged over 2x2 blocks
+static void write_y4m_frame(FILE *file, const unsigned char *rgba) {
+    size_t luma_size = (size_t)cwidth * cheight;
+    unsigned char *planes = malloc(luma_size * 3 / 2);
+    if (planes == NULL) return;
+    unsigned char *y_plane = planes, *u_plane = planes + luma_size, *v_plane = u_plane + luma_size / 4;
+
+    for (int y = 0; y < cheight; y++) {
+        const unsigned char *src = rgba + (size_t)(cheight - 1 - y) * cwidth * 4;
+        for (int x = 0; x < cwidth; x++, src += 4) {
+            y_plane[(size_t)y * cwidth + x] = (unsigned char)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+        }
+    }
+    for (int y = 0; y < cheight; y += 2) {
+        const unsigned char *row0 = rgba + (size_t)(cheight - 1 - y) * cwidth * 4;
+        const unsigned char *row1 = row0 - (size_t)cwidth * 4;
+        for (int x = 0; x < cwidth; x += 2) {
+            int r = row0[4 * x] + row0[4 * x + 4] + row1[4 * x] + row1[4 * x + 4];
+            int g = row0[4 * x + 1] + row0[4 * x + 5] + row1[4 * x + 1] + row1[4 * x + 5];
+            int b = row0[4 * x + 2] + row0[4 * x + 6] + row1[4 * x + 2] + row1[4 * x + 6];
+            size_t i = (size_t)(y / 2) * (cwidth / 2) + x / 2;
+            u_plane[i] = clamp_byte(128 + (-43 * r - 85 * g + 128 * b + 512) / 1024);
+            v_plane[i] = clamp_byte(128 + (128 * r - 107 * g - 21 * b + 512) / 1024);
+        }
+    }
+
+    fputs("FRAME\n", file);
+    fwrite(planes, 1, luma_size * 3 / 2, file);
+    free(planes);
+}
@@ -0,0 +1,46 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+/*
+* Asynchronous frame capture. Frames are read back into a ring of pixel buffer objects guarded by fences and
+* collected a few frames later, once the GPU has finished writing them, so the readback never stalls rendering.
+* Encoding runs on a background thread. No frame is dropped: if the encoder falls behind, capture_frame waits for
+* it. Frames are placed on the video's timeline by the time they were shown, and a frame that stayed on screen
+* for longer (a missed vblank, a stall) is repeated, so the video plays back at the speed it was recorded.
+*/
+
+/*
+* capture_set_output: Requests capture, call before capture_start. A path ending in ".y4m" records a raw YUV4MPEG2
+* (4:2:0) video, anything else is used as a prefix for a numbered PNG sequence (<path>_00000.png, ...).
+*
+* @param[in] path: output path or prefix, NULL to disable capture
+*/
+void capture_set_output(const char *path);
+
+/*
+* capture_start: Allocates the readback ring and starts the encoder thread, if capture was requested. Needs a
+* current GL context; capture_frame and capture_stop must be called from the same thread.
+*
+* @param[in] width, height: size of the region captured from the bottom left of the framebuffer
+* @param[in] fps: frame rate of the video, the rate frames are presented at
+*
+* @return 1 if capturing or if no capture was requested, 0 on failure
+*/
+int capture_start(int width, int height, int fps);
+
+// 1 between a successful capture_start that was asked to capture and capture_stop
+int capture_active();
+
+/*
+* capture_frame: Queues a readback of the current read framebuffer and hands finished readbacks to the encoder
+*
+* @param[in] time_ns: when the frame is shown. The first captured frame starts the video
+*/
+void capture_frame(uint64_t time_ns);
+
+// Collects outstanding readbacks, waits for the encoder to finish and prints capture statistics
+void capture_stop();
+
+#endif // !CAPTURE_H
@@ -19,6 +19,8 @@ int cl_kernels_init() {
     read_queue      = clCreateCommandQueueWithProperties(context, device, NULL, &error_code_ret); if (!CL_CHECK(error_code_ret)) return 0;
 
     kernel_vector_add_init();
+    kernel_cube_sim_init();     // both fall back to the host if they don't build
+    kernel_pruning_bfs_init();
 
     return 1;
 }
\ No newline at end of file
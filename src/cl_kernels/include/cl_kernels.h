@@ -1,7 +1,70 @@
 #ifndef CL_KERNELS_H
 #define CL_KERNELS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cube_state.h"
+#include "pruning_table.h"
+
 void cl_vector_add_float(int n, float *a, float *b, float *c);
 void cl_vector_add_int(int n, int *a, int *b, int *c);
 
-#endif //CL_KERNELS_H
\ No newline at end of file
+// Bytes per packed cube state: corners as cubie | twist << 3, edges as cubie | flip << 4, then the centres
+#define CUBE_SIM_FIELDS (NUM_CORNERS + NUM_EDGES + NUM_FACES)
+
+/*
+* Batch of packed cube states, structure of arrays: field f of state i is at fields[f * count + i]. The solved
+* state packs to each field holding its own slot number.
+*/
+typedef struct {
+    uint8_t *fields;
+    size_t count;
+} cube_sim_states;
+
+int cube_sim_states_alloc(cube_sim_states *states, size_t count);
+
+void cube_sim_states_free(cube_sim_states *states);
+
+void cube_sim_pack(cube_sim_states *states, size_t index, const cube_state *state);
+
+void cube_sim_unpack(const cube_sim_states *states, size_t index, cube_state *state);
+
+/*
+* cl_cube_sim_apply: Applies a move sequence to every state in the batch, on the OpenCL device when
+* kernel_cube_sim_init succeeded and on this thread otherwise. cube_state_init must have been called.
+*
+* @param[in, out] states: states to move, replaced by the results
+* @param[in] moves: every state's moves back to back
+* @param[in] offsets: state i applies moves[offsets[i]] up to moves[offsets[i + 1]], count + 1 entries
+* @param[out] solved: 1 for each state that ends solved, 0 otherwise, may be NULL
+*
+* @return 1 if successful, 0 if a move code is out of range or the batch is too large for the device
+*/
+int cl_cube_sim_apply(cube_sim_states *states, const uint8_t *moves, const uint32_t *offsets, uint8_t *solved);
+
+// 1 if kernel_cube_sim_init succeeded, so cl_cube_sim_apply runs on the device
+int cl_cube_sim_available();
+
+/*
+* cube_sim_apply_host: cl_cube_sim_apply run on this thread, the same arithmetic as the kernel. It is what the
+* device results are checked against. Move codes are not checked here.
+*/
+void cube_sim_apply_host(cube_sim_states *states, const uint8_t *moves, const uint32_t *offsets, uint8_t *solved);
+
+/*
+* cl_pruning_table_generate: pruning_table_generate for a product of coordinates, run on the OpenCL device. The
+* table stays in device memory while each layer is expanded in one kernel pass, and is copied back once finished.
+* The result is bit for bit what the host generator builds.
+*
+* @param[out] table: table to fill, allocated here
+* @param[in] product: coordinates and their move tables, at most 4G entries in all
+* @param[in] bits: 4, or 2 for distance mod 3
+* @param[in] name: printed with per-layer progress, NULL for none
+*
+* @return 1 if successful, 0 if kernel_pruning_bfs_init didn't succeed, the device failed or the table is too large,
+* in which case pruning_table_generate can build it instead
+*/
+int cl_pruning_table_generate(pruning_table *table, const coord_product *product, int bits, const char *name);
+
+#endif //CL_KERNELS_H
@@ -6,5 +6,7 @@ int cl_kernels_init();
 
 // Kernel Compilations
 int kernel_vector_add_init();
+int kernel_cube_sim_init();
+int kernel_pruning_bfs_init();
 
 #endif //CL_KERNELS_INIT_H
\ No newline at end of file
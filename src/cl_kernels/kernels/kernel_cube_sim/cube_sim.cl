@@ -0,0 +1,44 @@
+// Packed move, one byte per slot: corners hold the source slot | twist << 3, edges the source slot | flip << 4 and
+// centres the source slot
+#define MOVE_BYTES 26
+#define CORNERS 8
+#define EDGES 12
+#define CENTRES 6
+
+/*
+* Applies each state's move sequence, moves[offsets[id]] up to moves[offsets[id + 1]]. States are structure of
+* arrays, field f of state id at fields[f * count + id], so neighbouring work-items read neighbouring bytes.
+*/
+kernel void cube_sim(global uchar *fields, uint count, constant uchar *move_table, global const uchar *moves,
+    global const uint *offsets, global uchar *solved) {
+    uint id = get_global_id(0);
+    if (id >= count) return;
+
+    uchar state[2][MOVE_BYTES];
+    for (int f = 0; f < MOVE_BYTES; f++) state[0][f] = fields[f * count + id];
+
+    int current = 0;
+    uint end = offsets[id + 1];
+    for (uint k = offsets[id]; k < end; k++) {
+        constant uchar *move = move_table + moves[k] * MOVE_BYTES;
+        uchar *from = state[current];
+        uchar *to = state[current ^ 1];
+        for (int i = 0; i < CORNERS; i++) {
+            uchar corner = from[move[i] & 7];
+            uchar twist = (corner >> 3) + (move[i] >> 3);
+            to[i] = (corner & 7) | ((twist >= 3 ? twist - 3 : twist) << 3);
+        }
+        for (int i = 0; i < EDGES; i++) to[CORNERS + i] = from[CORNERS + (move[CORNERS + i] & 15)] ^ (move[CORNERS + i] & 16);
+        for (int i = 0; i < CENTRES; i++) to[CORNERS + EDGES + i] = from[CORNERS + EDGES + move[CORNERS + EDGES + i]];
+        current ^= 1;
+    }
+
+    // Solved is every slot holding its own cubie unturned, which packs to the slot number in each field group
+    uchar wrong = 0;
+    for (int f = 0; f < MOVE_BYTES; f++) {
+        uchar home = (f < CORNERS) ? f : (f < CORNERS + EDGES) ? f - CORNERS : f - CORNERS - EDGES;
+        fields[f * count + id] = state[current][f];
+        wrong |= state[current][f] ^ home;
+    }
+    if (solved) solved[id] = (wrong == 0);
+}
@@ -0,0 +1,194 @@
+#include "cl_kernels_context.h"
+#include "cl_kernels_init.h"
+#include "cl_kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "read_file.h"
+
+#define WORK_GROUP_SIZE 64
+
+static cl_kernel kernel;
+static cl_mem move_table_buffer;
+static int available = 0;
+
+// Every move packed the way the kernel reads it, indexed [move * CUBE_SIM_FIELDS + field]
+static void pack_move_table(uint8_t table[NUM_MOVES * CUBE_SIM_FIELDS]) {
+    for (int m = 0; m < NUM_MOVES; m++) {
+        const cube_state *move = cube_state_move((uint8_t)m);
+        uint8_t *packed = &table[m * CUBE_SIM_FIELDS];
+        for (int i = 0; i < NUM_CORNERS; i++) packed[i] = move->cp[i] | (move->co[i] << 3);
+        for (int i = 0; i < NUM_EDGES; i++) packed[NUM_CORNERS + i] = move->ep[i] | (move->eo[i] << 4);
+        for (int i = 0; i < NUM_FACES; i++) packed[NUM_CORNERS + NUM_EDGES + i] = move->centres[i];
+    }
+}
+
+int kernel_cube_sim_init() {
+    cl_int error_code;
+    available = 0;
+    cube_state_init();
+
+    // Compile kernel
+    char *program_source = read_file(KERNEL_SOURCE_DIR "kernel_cube_sim/cube_sim.cl");
+    if (program_source == NULL) return 0;
+    const char *sources[] = { program_source };
+    cl_program program = clCreateProgramWithSource(context, 1, sources, NULL, &error_code);
+    free(program_source);
+    if (!CL_CHECK(error_code)) return 0;
+    if (!CL_CHECK(clBuildProgram(program, 0, NULL, NULL, NULL, NULL))) {
+        clReleaseProgram(program);
+        return 0;
+    }
+    kernel = clCreateKernel(program, "cube_sim", &error_code);
+    clReleaseProgram(program);
+    if (!CL_CHECK(error_code)) return 0;
+
+    // Move tables are read by every work-item, so they go in constant memory
+    uint8_t table[NUM_MOVES * CUBE_SIM_FIELDS];
+    pack_move_table(table);
+    move_table_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(table), table, &error_code);
+    if (!CL_CHECK(error_code)) {
+        clReleaseKernel(kernel);
+        return 0;
+    }
+
+    available = 1;
+    return 1;
+}
+
+int cl_cube_sim_available() {
+    return available;
+}
+
+int cube_sim_states_alloc(cube_sim_states *states, size_t count) {
+    states->fields = malloc(count * CUBE_SIM_FIELDS);
+    states->count = count;
+    return states->fields != NULL;
+}
+
+void cube_sim_states_free(cube_sim_states *states) {
+    free(states->fields);
+    states->fields = NULL;
+    states->count = 0;
+}
+
+void cube_sim_pack(cube_sim_states *states, size_t index, const cube_state *state) {
+    uint8_t *field = states->fields + index;
+    for (int i = 0; i < NUM_CORNERS; i++, field += states->count) *field = state->cp[i] | (state->co[i] << 3);
+    for (int i = 0; i < NUM_EDGES; i++, field += states->count) *field = state->ep[i] | (state->eo[i] << 4);
+    for (int i = 0; i < NUM_FACES; i++, field += states->count) *field = state->centres[i];
+}
+
+void cube_sim_unpack(const cube_sim_states *states, size_t index, cube_state *state) {
+    const uint8_t *field = states->fields + index;
+    for (int i = 0; i < NUM_CORNERS; i++, field += states->count) {
+        state->cp[i] = *field & 7;
+        state->co[i] = *field >> 3;
+    }
+    for (int i = 0; i < NUM_EDGES; i++, field += states->count) {
+        state->ep[i] = *field & 15;
+        state->eo[i] = *field >> 4;
+    }
+    for (int i = 0; i < NUM_FACES; i++, field += states->count) state->centres[i] = *field;
+}
+
+// Same arithmetic as the kernel, one state at a time
+void cube_sim_apply_host(cube_sim_states *states, const uint8_t *moves, const uint32_t *offsets, uint8_t *solved) {
+    uint8_t table[NUM_MOVES * CUBE_SIM_FIELDS];
+    pack_move_table(table);
+
+    for (size_t id = 0; id < states->count; id++) {
+        uint8_t state[2][CUBE_SIM_FIELDS];
+        for (int f = 0; f < CUBE_SIM_FIELDS; f++) state[0][f] = states->fields[f * states->count + id];
+
+        int current = 0;
+        for (uint32_t k = offsets[id]; k < offsets[id + 1]; k++) {
+            const uint8_t *move = &table[moves[k] * CUBE_SIM_FIELDS];
+            const uint8_t *from = state[current];
+            uint8_t *to = state[current ^ 1];
+            for (int i = 0; i < NUM_CORNERS; i++) {
+                uint8_t corner = from[move[i] & 7];
+                uint8_t twist = (corner >> 3) + (move[i] >> 3);
+                to[i] = (corner & 7) | (((twist >= 3) ? twist - 3 : twist) << 3);
+            }
+            for (int i = 0; i < NUM_EDGES; i++) to[NUM_CORNERS + i] = from[NUM_CORNERS + (move[NUM_CORNERS + i] & 15)] ^ (move[NUM_CORNERS + i] & 16);
+            for (int i = 0; i < NUM_FACES; i++) to[NUM_CORNERS + NUM_EDGES + i] = from[NUM_CORNERS + NUM_EDGES + move[NUM_CORNERS + NUM_EDGES + i]];
+            current ^= 1;
+        }
+
+        uint8_t wrong = 0;
+        for (int f = 0; f < CUBE_SIM_FIELDS; f++) {
+            int home = (f < NUM_CORNERS) ? f : (f < NUM_CORNERS + NUM_EDGES) ? f - NUM_CORNERS : f - NUM_CORNERS - NUM_EDGES;
+            states->fields[f * states->count + id] = state[current][f];
+            wrong |= state[current][f] ^ home;
+        }
+        if (solved) solved[id] = (wrong == 0);
+    }
+}
+
+// Runs the batch on the device, 0 if any step fails so the caller can redo it on the host
+static int apply_on_device(cube_sim_states *states, const uint8_t *moves, const uint32_t *offsets, uint8_t *solved) {
+    cl_int error_code;
+    size_t count = states->count;
+    size_t num_moves = offsets[count];
+    size_t fields_size = count * CUBE_SIM_FIELDS;
+    cl_mem fields_buffer = NULL, moves_buffer = NULL, offsets_buffer = NULL, solved_buffer = NULL;
+    cl_event writes[3] = { NULL, NULL, NULL }, kernel_done = NULL;
+    int num_writes = 0, ok = 0;
+
+    fields_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, fields_size, NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    // Buffers can't be empty, so a batch with no moves still gets one byte
+    moves_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY, num_moves ? num_moves : 1, NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    offsets_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY, (count + 1) * sizeof(uint32_t), NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    if (solved) {
+        solved_buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, count, NULL, &error_code);
+        if (!CL_CHECK(error_code)) goto cleanup;
+    }
+
+    if (!CL_CHECK(clEnqueueWriteBuffer(write_queue, fields_buffer, CL_FALSE, 0, fields_size, states->fields, 0, NULL, &writes[num_writes++]))) goto cleanup;
+    if (num_moves && !CL_CHECK(clEnqueueWriteBuffer(write_queue, moves_buffer, CL_FALSE, 0, num_moves, moves, 0, NULL, &writes[num_writes++]))) goto cleanup;
+    if (!CL_CHECK(clEnqueueWriteBuffer(write_queue, offsets_buffer, CL_FALSE, 0, (count + 1) * sizeof(uint32_t), offsets, 0, NULL, &writes[num_writes++]))) goto cleanup;
+
+    cl_uint count_arg = (cl_uint)count;
+    if (!CL_CHECK(clSetKernelArg(kernel, 0, sizeof(cl_mem), &fields_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 1, sizeof(cl_uint), &count_arg))
+        || !CL_CHECK(clSetKernelArg(kernel, 2, sizeof(cl_mem), &move_table_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 3, sizeof(cl_mem), &moves_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 4, sizeof(cl_mem), &offsets_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 5, sizeof(cl_mem), solved ? &solved_buffer : NULL))) goto cleanup;
+
+    size_t global_size = (count + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE * WORK_GROUP_SIZE;
+    if (!CL_CHECK(clEnqueueNDRangeKernel(kernel_queue, kernel, 1, NULL, &global_size, NULL, (cl_uint)num_writes, writes, &kernel_done))) goto cleanup;
+    if (!CL_CHECK(clEnqueueReadBuffer(read_queue, fields_buffer, CL_TRUE, 0, fields_size, states->fields, 1, &kernel_done, NULL))) goto cleanup;
+    if (solved && !CL_CHECK(clEnqueueReadBuffer(read_queue, solved_buffer, CL_TRUE, 0, count, solved, 1, &kernel_done, NULL))) goto cleanup;
+    ok = 1;
+
+cleanup:
+    // A write that failed to enqueue left no event, and the device may still be reading the host arrays otherwise
+    if (!ok) clFinish(write_queue);
+    for (int i = 0; i < num_writes; i++) {
+        if (writes[i]) clReleaseEvent(writes[i]);
+    }
+    if (kernel_done) clReleaseEvent(kernel_done);
+    if (solved_buffer) clReleaseMemObject(solved_buffer);
+    if (offsets_buffer) clReleaseMemObject(offsets_buffer);
+    if (moves_buffer) clReleaseMemObject(moves_buffer);
+    if (fields_buffer) clReleaseMemObject(fields_buffer);
+    return ok;
+}
+
+int cl_cube_sim_apply(cube_sim_states *states, const uint8_t *moves, const uint32_t *offsets, uint8_t *solved) {
+    if (states->count == 0) return 1;
+    if ((uint64_t)states->count > UINT32_MAX) return 0;
+    for (uint32_t k = 0; k < offsets[states->count]; k++) {
+        if (moves[k] >= NUM_MOVES) return 0;
+    }
+
+    if (available && apply_on_device(states, moves, offsets, solved)) return 1;
+    cube_sim_apply_host(states, moves, offsets, solved);
+    return 1;
+}
@@ -0,0 +1,163 @@
+#include "cl_kernels_context.h"
+#include "cl_kernels_init.h"
+#include "cl_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "read_file.h"
+#include "timer.h"
+
+#define WORK_GROUP_SIZE 64
+
+// Mirrors product_layout in pruning_bfs.cl
+typedef struct {
+    cl_uint num_coords;
+    cl_uint num_moves;
+    cl_uint count[MAX_PRODUCT_COORDS];
+    cl_uint offset[MAX_PRODUCT_COORDS];
+} product_layout;
+
+static cl_kernel kernel;
+static int available = 0;
+
+int kernel_pruning_bfs_init() {
+    cl_int error_code;
+    available = 0;
+
+    // Compile kernel
+    char *program_source = read_file(KERNEL_SOURCE_DIR "kernel_pruning_bfs/pruning_bfs.cl");
+    if (program_source == NULL) return 0;
+    const char *sources[] = { program_source };
+    cl_program program = clCreateProgramWithSource(context, 1, sources, NULL, &error_code);
+    free(program_source);
+    if (!CL_CHECK(error_code)) return 0;
+    if (!CL_CHECK(clBuildProgram(program, 0, NULL, NULL, NULL, NULL))) {
+        clReleaseProgram(program);
+        return 0;
+    }
+    kernel = clCreateKernel(program, "bfs_layer", &error_code);
+    clReleaseProgram(program);
+    if (!CL_CHECK(error_code)) return 0;
+
+    available = 1;
+    return 1;
+}
+
+// Runs the layers with the table in device memory, reading back only each layer's count and then the whole table
+static int generate_on_device(pruning_table *table, const coord_product *product, uint64_t goal, const char *name) {
+    cl_int error_code;
+    int bits = table->bits;
+    int per_word = 32 / bits;
+    size_t num_words = (size_t)((table->size + (uint64_t)per_word - 1) / (uint64_t)per_word);
+    cl_mem words_buffer = NULL, layout_buffer = NULL, tables_buffer = NULL, found_buffer = NULL;
+    int ok = 0;
+
+    // Every coordinate's move table back to back
+    product_layout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.num_coords = (cl_uint)product->num_coords;
+    layout.num_moves = (cl_uint)product->num_moves;
+    size_t num_entries = 0;
+    for (int i = 0; i < product->num_coords; i++) {
+        layout.count[i] = product->count[i];
+        layout.offset[i] = (cl_uint)num_entries;
+        num_entries += (size_t)product->count[i] * (size_t)product->num_moves;
+    }
+
+    words_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, num_words * sizeof(cl_uint), NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    layout_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(layout), &layout, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    tables_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY, num_entries * sizeof(cl_ushort), NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+    found_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, &error_code);
+    if (!CL_CHECK(error_code)) goto cleanup;
+
+    for (int i = 0; i < product->num_coords; i++) {
+        size_t entries = (size_t)product->count[i] * (size_t)product->num_moves;
+        if (!CL_CHECK(clEnqueueWriteBuffer(kernel_queue, tables_buffer, CL_TRUE, layout.offset[i] * sizeof(cl_ushort),
+            entries * sizeof(cl_ushort), product->move[i], 0, NULL, NULL))) goto cleanup;
+    }
+
+    // Everything unknown but the goal
+    cl_uint all_unknown = 0xFFFFFFFFu;
+    if (!CL_CHECK(clEnqueueFillBuffer(kernel_queue, words_buffer, &all_unknown, sizeof(all_unknown), 0, num_words * sizeof(cl_uint), 0, NULL, NULL))) goto cleanup;
+    cl_uint goal_word = all_unknown & ~(PRUNING_UNKNOWN(bits) << ((goal % (uint64_t)per_word) * (uint64_t)bits));
+    if (!CL_CHECK(clEnqueueWriteBuffer(kernel_queue, words_buffer, CL_TRUE, (size_t)(goal / (uint64_t)per_word) * sizeof(cl_uint),
+        sizeof(cl_uint), &goal_word, 0, NULL, NULL))) goto cleanup;
+
+    cl_uint size_arg = (cl_uint)table->size, bits_arg = (cl_uint)bits;
+    if (!CL_CHECK(clSetKernelArg(kernel, 0, sizeof(cl_mem), &words_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 1, sizeof(cl_uint), &size_arg))
+        || !CL_CHECK(clSetKernelArg(kernel, 2, sizeof(cl_uint), &bits_arg))
+        || !CL_CHECK(clSetKernelArg(kernel, 3, sizeof(cl_mem), &layout_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 4, sizeof(cl_mem), &tables_buffer))
+        || !CL_CHECK(clSetKernelArg(kernel, 8, sizeof(cl_mem), &found_buffer))) goto cleanup;
+
+    size_t global_size = (num_words + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE * WORK_GROUP_SIZE;
+    uint64_t start_ns = timer_now_ns();
+    uint64_t filled = 1;
+    for (unsigned int depth = 0; filled < table->size; depth++) {
+        if ((bits == 4) && (depth + 1 >= PRUNING_UNKNOWN(4))) {
+            printf("Pruning table %s: distances exceed %u, too deep for 4-bit entries\n", name ? name : "", PRUNING_UNKNOWN(4) - 1);
+            goto cleanup;
+        }
+
+        cl_uint backward = filled > table->size / 2;
+        cl_uint current = (bits == 4) ? depth : depth % 3;
+        cl_uint next = (bits == 4) ? depth + 1 : (depth + 1) % 3;
+        cl_uint found = 0;
+        if (!CL_CHECK(clEnqueueWriteBuffer(kernel_queue, found_buffer, CL_FALSE, 0, sizeof(cl_uint), &found, 0, NULL, NULL))
+            || !CL_CHECK(clSetKernelArg(kernel, 5, sizeof(cl_uint), &current))
+            || !CL_CHECK(clSetKernelArg(kernel, 6, sizeof(cl_uint), &next))
+            || !CL_CHECK(clSetKernelArg(kernel, 7, sizeof(cl_uint), &backward))
+            || !CL_CHECK(clEnqueueNDRangeKernel(kernel_queue, kernel, 1, NULL, &global_size, NULL, 0, NULL, NULL))
+            || !CL_CHECK(clEnqueueReadBuffer(kernel_queue, found_buffer, CL_TRUE, 0, sizeof(cl_uint), &found, 0, NULL, NULL))) goto cleanup;
+
+        filled += found;
+        if (name) {
+            double seconds = (double)(timer_now_ns() - start_ns) / NS_PER_SEC;
+            printf("%s: depth %2u %12llu states (%5.1f%%, %s) %7.2f s %8.2f M states/s on the device\n", name, depth + 1,
+                (unsigned long long)found, 100.0 * (double)filled / (double)table->size, backward ? "backward" : "forward ",
+                seconds, (double)filled / seconds / 1e6);
+        }
+        if (found == 0) break;
+    }
+
+    ok = CL_CHECK(clEnqueueReadBuffer(kernel_queue, words_buffer, CL_TRUE, 0, num_words * sizeof(cl_uint), table->words, 0, NULL, NULL));
+
+cleanup:
+    if (!ok) clFinish(kernel_queue);
+    if (found_buffer) clReleaseMemObject(found_buffer);
+    if (tables_buffer) clReleaseMemObject(tables_buffer);
+    if (layout_buffer) clReleaseMemObject(layout_buffer);
+    if (words_buffer) clReleaseMemObject(words_buffer);
+    return ok;
+}
+
+int cl_pruning_table_generate(pruning_table *table, const coord_product *product, int bits, const char *name) {
+    coord_space space;
+    coord_product_space(product, &space);
+    table->words = NULL;
+    if (!available || (space.size > UINT32_MAX)) return 0;
+
+    int per_word = 32 / bits;
+    uint64_t num_words = (space.size + (uint64_t)per_word - 1) / (uint64_t)per_word;
+    table->words = malloc(num_words * sizeof(uint32_t));
+    if (table->words == NULL) {
+        printf("Failed to allocate %llu MB for pruning table\n", (unsigned long long)(num_words * sizeof(uint32_t) >> 20));
+        return 0;
+    }
+    table->size = space.size;
+    table->bits = bits;
+    table->mapping = NULL;
+    table->mapping_size = 0;
+
+    if (!generate_on_device(table, product, space.goal, name)) {
+        pruning_table_free(table);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,78 @@
+#define MAX_PRODUCT_COORDS 4
+
+// Product of coordinates, laid out as the host fills it: each coordinate's count and where its move table,
+// indexed [coordinate * num_moves + move], starts in the tables buffer
+typedef struct {
+    uint num_coords;
+    uint num_moves;
+    uint count[MAX_PRODUCT_COORDS];
+    uint offset[MAX_PRODUCT_COORDS];
+} product_layout;
+
+// Sets an entry if it is still unknown, returns 1 if this call set it
+static uint claim_entry(volatile global uint *words, uint index, uint value, uint bits, uint word_shift) {
+    uint shift = (index & ((1u << word_shift) - 1)) * bits;
+    uint mask = ((1u << bits) - 1) << shift;
+    volatile global uint *word = &words[index >> word_shift];
+    uint old = *word;
+    while ((old & mask) == mask) {
+        uint seen = atomic_cmpxchg(word, old, (old & ~mask) | (value << shift));
+        if (seen == old) return 1;
+        old = seen;
+    }
+    return 0;
+}
+
+/*
+* One breadth-first layer, one work-item per word of entries. Forward, every entry in the current layer claims its
+* unknown neighbours; backward, every unknown entry joins the next layer if a neighbour is in the current one, and
+* as it only writes its own word it needs no atomics. Same rules as the host generator, so the tables match bit
+* for bit.
+*/
+kernel void bfs_layer(volatile global uint *words, uint size, uint bits, constant product_layout *product,
+    global const ushort *tables, uint current, uint next, uint backward, volatile global uint *found) {
+    uint word_shift = (bits == 4) ? 3 : 4;
+    uint unknown = (1u << bits) - 1;
+    uint word_index = get_global_id(0);
+    uint first = word_index << word_shift;
+    if (first >= size) return;
+
+    // Whole words with nothing to do are common at both ends of the search
+    uint word = words[word_index];
+    uint low = (bits == 4) ? 0x11111111u : 0x55555555u;
+    uint all_set = (bits == 4) ? (word & (word >> 1) & (word >> 2) & (word >> 3)) : (word & (word >> 1));
+    if (backward ? ((all_set & low) == 0) : (word == 0xFFFFFFFFu)) return;
+
+    uint num_coords = product->num_coords;
+    uint num_moves = product->num_moves;
+    uint per_word = 1u << word_shift;
+    uint claimed = 0;
+    for (uint j = 0; (j < per_word) && (first + j < size); j++) {
+        uint value = (word >> (j * bits)) & unknown;
+        if (value != (backward ? unknown : current)) continue;
+
+        uint coord[MAX_PRODUCT_COORDS], scale[MAX_PRODUCT_COORDS];
+        uint rest = first + j, place = 1;
+        for (int i = (int)num_coords - 1; i >= 0; i--) {
+            coord[i] = rest % product->count[i];
+            rest /= product->count[i];
+            scale[i] = place;
+            place *= product->count[i];
+        }
+
+        for (uint m = 0; m < num_moves; m++) {
+            uint neighbour = 0;
+            for (uint i = 0; i < num_coords; i++) neighbour += tables[product->offset[i] + coord[i] * num_moves + m] * scale[i];
+            if (backward) {
+                if (((words[neighbour >> word_shift] >> ((neighbour & (per_word - 1)) * bits)) & unknown) == current) {
+                    word = (word & ~(unknown << (j * bits))) | (next << (j * bits));
+                    claimed++;
+                    break;
+                }
+            }
+            else claimed += claim_entry(words, neighbour, next, bits, word_shift);
+        }
+    }
+    if (backward && claimed) words[word_index] = word;
+    if (claimed) atomic_add(found, claimed);
+}
@@ -11,7 +11,7 @@ int kernel_vector_add_init() {
     cl_int error_code;
 
     // Compile kernel
-    const char* program_source = read_file(KERNEL_SOURCE_DIR "vector_add.cl");
+    const char* program_source = read_file(KERNEL_SOURCE_DIR "kernel_vector_add/vector_add.cl");
     const cl_program program = clCreateProgramWithSource(context, 1, &program_source, NULL, &error_code);
     if (!CL_CHECK(error_code)) return 0;
     free(program_source);
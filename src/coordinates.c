@@ -0,0 +1,149 @@
+#include "coordinates.h"
+
+static unsigned int binomial(int n, int k) {
+    if ((k < 0) || (k > n)) return 0;
+    unsigned int result = 1;
+    for (int i = 1; i <= k; i++) result = result * (unsigned int)(n - k + i) / (unsigned int)i;
+    return result;
+}
+
+uint32_t permutation_rank(const uint8_t *p, int n) {
+    uint32_t rank = 0;
+    for (int i = 0; i < n; i++) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; j++) smaller += p[j] < p[i];
+        rank = rank * (uint32_t)(n - i) + (uint32_t)smaller;
+    }
+    return rank;
+}
+
+void permutation_unrank(uint32_t rank, uint8_t *p, int n) {
+    // Peel the Lehmer digits off the least significant end, then pick each element from those still unused
+    uint8_t digits[16];
+    for (int i = n - 1; i >= 0; i--) {
+        digits[i] = (uint8_t)(rank % (uint32_t)(n - i));
+        rank /= (uint32_t)(n - i);
+    }
+
+    uint8_t unused[16];
+    for (int i = 0; i < n; i++) unused[i] = (uint8_t)i;
+    for (int i = 0; i < n; i++) {
+        int d = digits[i];
+        p[i] = unused[d];
+        for (int j = d; j < n - i - 1; j++) unused[j] = unused[j + 1];
+    }
+}
+
+int permutation_parity(const uint8_t *p, int n) {
+    int parity = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) parity ^= p[i] > p[j];
+    }
+    return parity;
+}
+
+unsigned int coord_twist(const cube_state *state) {
+    unsigned int twist = 0;
+    for (int i = 0; i < NUM_CORNERS - 1; i++) twist = twist * 3 + state->co[i];
+    return twist;
+}
+
+void coord_set_twist(cube_state *state, unsigned int twist) {
+    unsigned int sum = 0;
+    for (int i = NUM_CORNERS - 2; i >= 0; i--) {
+        state->co[i] = twist % 3;
+        sum += state->co[i];
+        twist /= 3;
+    }
+    state->co[NUM_CORNERS - 1] = (3 - sum % 3) % 3;
+}
+
+unsigned int coord_flip(const cube_state *state) {
+    unsigned int flip = 0;
+    for (int i = 0; i < NUM_EDGES - 1; i++) flip = flip * 2 + state->eo[i];
+    return flip;
+}
+
+void coord_set_flip(cube_state *state, unsigned int flip) {
+    unsigned int sum = 0;
+    for (int i = NUM_EDGES - 2; i >= 0; i--) {
+        state->eo[i] = flip & 1;
+        sum += state->eo[i];
+        flip >>= 1;
+    }
+    state->eo[NUM_EDGES - 1] = sum & 1;
+}
+
+unsigned int coord_corner_perm(const cube_state *state) {
+    return permutation_rank(state->cp, NUM_CORNERS);
+}
+
+void coord_set_corner_perm(cube_state *state, unsigned int rank) {
+    permutation_unrank(rank, state->cp, NUM_CORNERS);
+}
+
+unsigned int coord_edge_perm(const cube_state *state) {
+    return permutation_rank(state->ep, NUM_EDGES);
+}
+
+void coord_set_edge_perm(cube_state *state, unsigned int rank) {
+    permutation_unrank(rank, state->ep, NUM_EDGES);
+}
+
+unsigned int coord_slice(const cube_state *state) {
+    unsigned int slice = 0;
+    int found = 0;
+    for (int j = NUM_EDGES - 1; j >= 0; j--) {
+        if (state->ep[j] >= EDGE_FR) slice += binomial(NUM_EDGES - 1 - j, ++found);
+    }
+    return slice;
+}
+
+void coord_set_slice(cube_state *state, unsigned int slice) {
+    int left = 4, next_slice = EDGE_FR, next_other = EDGE_UR;
+    for (int j = 0; j < NUM_EDGES; j++) {
+        unsigned int c = binomial(NUM_EDGES - 1 - j, left);
+        if ((left > 0) && (slice >= c)) {
+            slice -= c;
+            left--;
+            state->ep[j] = next_slice++;
+        }
+        else state->ep[j] = next_other++;
+    }
+}
+
+unsigned int coord_ud_edge_perm(const cube_state *state) {
+    return permutation_rank(state->ep, EDGE_FR);
+}
+
+void coord_set_ud_edge_perm(cube_state *state, unsigned int rank) {
+    permutation_unrank(rank, state->ep, EDGE_FR);
+    for (int i = EDGE_FR; i < NUM_EDGES; i++) state->ep[i] = i;
+}
+
+unsigned int coord_slice_perm(const cube_state *state) {
+    uint8_t slice[4];
+    for (int i = 0; i < 4; i++) slice[i] = state->ep[EDGE_FR + i] - EDGE_FR;
+    return permutation_rank(slice, 4);
+}
+
+void coord_set_slice_perm(cube_state *state, unsigned int rank) {
+    uint8_t slice[4];
+    permutation_unrank(rank, slice, 4);
+    for (int i = 0; i < EDGE_FR; i++) state->ep[i] = i;
+    for (int i = 0; i < 4; i++) state->ep[EDGE_FR + i] = EDGE_FR + slice[i];
+}
+
+void coord_move_table(uint16_t *table, unsigned int count, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), const uint8_t *moves, int num_moves) {
+    for (unsigned int i = 0; i < count; i++) {
+        cube_state state;
+        cube_state_solved(&state);
+        set(&state, i);
+        for (int m = 0; m < num_moves; m++) {
+            cube_state moved;
+            cube_state_multiply(&state, cube_state_move(moves[m]), &moved);
+            table[i * num_moves + m] = (uint16_t)get(&moved);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef COORDINATES_H
+#define COORDINATES_H
+
+#include <stdint.h>
+
+#include "cube_state.h"
+
+/*
+* Coordinates number one aspect of a cube state from 0 to its count - 1. Getters ignore every other aspect and
+* setters leave it unchanged, so a state can be built up one coordinate at a time.
+*/
+#define NUM_TWISTS 2187             // 3^7, the last corner's twist follows from the others
+#define NUM_FLIPS 2048              // 2^11, likewise for the last edge
+#define NUM_CORNER_PERMS 40320      // 8!
+#define NUM_EDGE_PERMS 479001600    // 12!
+#define NUM_SLICES 495              // 12 choose 4 places for the FR FL BL BR edges
+#define NUM_UD_EDGE_PERMS 40320     // 8!, edges of the U and D layers once the slice edges are in the slice
+#define NUM_SLICE_PERMS 24          // 4!, slice edges among themselves
+
+unsigned int coord_twist(const cube_state *state);
+void coord_set_twist(cube_state *state, unsigned int twist);
+
+unsigned int coord_flip(const cube_state *state);
+void coord_set_flip(cube_state *state, unsigned int flip);
+
+unsigned int coord_corner_perm(const cube_state *state);
+void coord_set_corner_perm(cube_state *state, unsigned int rank);
+
+unsigned int coord_edge_perm(const cube_state *state);
+void coord_set_edge_perm(cube_state *state, unsigned int rank);
+
+// Which slots hold the slice edges, 0 when they are all in the slice. Setting fills them in in order.
+unsigned int coord_slice(const cube_state *state);
+void coord_set_slice(cube_state *state, unsigned int slice);
+
+// Only meaningful with the slice edges in the slice, setting puts them back there in their home order
+unsigned int coord_ud_edge_perm(const cube_state *state);
+void coord_set_ud_edge_perm(cube_state *state, unsigned int rank);
+
+// Only meaningful with the slice edges in the slice, setting puts the other edges home
+unsigned int coord_slice_perm(const cube_state *state);
+void coord_set_slice_perm(cube_state *state, unsigned int rank);
+
+/*
+* coord_move_table: Tabulates a coordinate after each of a set of moves, by setting it on the solved cube, applying
+* the move and reading it back
+*
+* @param[out] table: count * num_moves entries, indexed [coordinate * num_moves + move]
+* @param[in] count: number of coordinate values
+* @param[in] get: coordinate getter
+* @param[in] set: coordinate setter
+* @param[in] moves: move codes
+* @param[in] num_moves: number of moves
+*/
+void coord_move_table(uint16_t *table, unsigned int count, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), const uint8_t *moves, int num_moves);
+
+// Lehmer code rank of a permutation of 0..n-1, and its inverse
+uint32_t permutation_rank(const uint8_t *p, int n);
+void permutation_unrank(uint32_t rank, uint8_t *p, int n);
+
+// 1 if the permutation is odd
+int permutation_parity(const uint8_t *p, int n);
+
+#endif // !COORDINATES_H
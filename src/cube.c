@@ -4,6 +4,7 @@
 
 #include "vector.h"
 #include "quaternion.h"
+#include "cube_state.h"
 
 /*
 333 Cube (with center cube removed -> 26 total)
@@ -52,20 +53,17 @@ Back    -   Blue
 
 // -------------------------- Colours ----------------------------------
 
-#define GREEN 0.f
-#define BLUE 1.f
-#define ORANGE 2.f
-#define RED 3.f
-#define YELLOW 4.f
-#define WHITE 5.f
-#define BLACK 6.f
+#define GREEN 0
+#define BLUE 1
+#define ORANGE 2
+#define RED 3
+#define YELLOW 4
+#define WHITE 5
+#define BLACK 6
 
 
 // -------------------------- Cube dimensions definitions --------------
 
-#define NUM_CUBES 26
-#define FACES_PER_CUBE 6
-
 // Vertex specific
 #define VERTEX_PER_FACE 4
 #define VERTEX_SIZE 3
@@ -75,19 +73,36 @@ Back    -   Blue
 #define INDEX_PER_TRIANGLE 3
 
 // Texture specific
-#define TEX_COORD_SIZE 2
-#define COLOUR_SIZE 1
+#define TEX_COORD_ONE 255 // normalized unsigned byte
 
 // -------------------------- Cube state ------------------------------
 
 static vec3 pos;
 static quaternion orientation;
+static quaternion tick_orientation[2]; // orientation at the previous and the latest simulation step
+static mat4 cubie_transforms[NUM_CUBES]; // rotation of each cubie about the cube centre
+static cube_state logical_state;
+static unsigned char sticker_colours[NUM_CUBES * FACES_PER_CUBE];
+
+/*
+* The mesh has U (yellow) up and F (green) towards -z, where the camera is, so the cube_state frame (x right, y up,
+* z towards the viewer) maps to the world's (-x, y, -z). Colours of the faces as cube_state names them, URFDLB.
+*/
+static const unsigned char face_colour[NUM_FACES] = { YELLOW, ORANGE, GREEN, WHITE, RED, BLUE };
+
+// Outward normal of each face of a single cube, in the order of single_cube_vertices
+static const int mesh_face_normal[FACES_PER_CUBE][3] = {
+    { 0, 1, 0 }, { 0, -1, 0 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 0, -1 }, { 0, 0, 1 }
+};
+
+static int cubie_positions[NUM_CUBES][3];               // world offsets, in cube_vertex_info order
+static int face_facelets[NUM_CUBES * FACES_PER_CUBE];   // facelet shown on each cubie face, -1 for inner faces
 
 
 // -------------------------- 1 x 1 x 1 CUBE (Helper) -----------------
 
 
-static float single_cube_vertices[FACES_PER_CUBE * VERTEX_PER_FACE * VERTEX_SIZE] = {
+static const float single_cube_vertices[FACES_PER_CUBE * VERTEX_PER_FACE * VERTEX_SIZE] = {
     // Top face (y + 0.5)
      0.5f,  0.5f, -0.5f,  // front right    1   3
     -0.5f,  0.5f, -0.5f,  // front left     2
@@ -125,8 +140,13 @@ static float single_cube_vertices[FACES_PER_CUBE * VERTEX_PER_FACE * VERTEX_SIZE
      0.5f, -0.5f,  0.5f,  // bottom right       2
 };
 
+// Texture coordinates of each face's corners, in the order of single_cube_vertices
+static const uint8_t single_face_tex_coords[VERTEX_PER_FACE][2] = {
+    { 0, 0 }, { 0, TEX_COORD_ONE }, { TEX_COORD_ONE, TEX_COORD_ONE }, { TEX_COORD_ONE, 0 }
+};
+
 // Defined in such a way as the triangle wind outward
-static unsigned int single_cube_indices[FACES_PER_CUBE * TRIANGLE_PER_FACE * INDEX_PER_TRIANGLE] = {
+static const unsigned short single_cube_indices[FACES_PER_CUBE * TRIANGLE_PER_FACE * INDEX_PER_TRIANGLE] = {
     // Top face
     0, 1, 2,
     2, 3, 0,
@@ -149,200 +169,11 @@ static unsigned int single_cube_indices[FACES_PER_CUBE * TRIANGLE_PER_FACE * IND
 
 // -------------------------- 3 x 3 x 3 CUBE --------------------------
 
-float vertices[NUM_CUBES * FACES_PER_CUBE * VERTEX_PER_FACE * VERTEX_SIZE] = { 0 };
-unsigned int indices[NUM_CUBES * FACES_PER_CUBE * TRIANGLE_PER_FACE * INDEX_PER_TRIANGLE] = { 0 };
-float texture_info[NUM_CUBES * FACES_PER_CUBE * VERTEX_PER_FACE * (TEX_COORD_SIZE + COLOUR_SIZE) ] = {
-    // ----- TOP LAYER -----
-    // Cube 1
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 2
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 3
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 4   
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 5
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 6
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 7
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 8
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 9
-    0.f, 0.f, YELLOW,  0.f, 1.f, YELLOW,  1.f, 1.f, YELLOW,  1.f, 0.f, YELLOW,  // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-
-    // ----- MIDDLE LAYER -----
-    // Cube 10
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 11
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 12
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 13
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 14
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 15
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 16
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 17
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-
-    // ----- BOTTOM LAYER -----
-    // Cube 18
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 19
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 20
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLUE,    0.f, 1.f, BLUE,    1.f, 1.f, BLUE,    1.f, 0.f, BLUE,    // Back
-    // Cube 21
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 22
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 23
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 24
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, RED,     0.f, 1.f, RED,     1.f, 1.f, RED,     1.f, 0.f, RED,     // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 25
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Back
-    // Cube 26
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Top
-    0.f, 0.f, WHITE,   0.f, 1.f, WHITE,   1.f, 1.f, WHITE,   1.f, 0.f, WHITE,   // Bottom
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK,   // Right
-    0.f, 0.f, ORANGE,  0.f, 1.f, ORANGE,  1.f, 1.f, ORANGE,  1.f, 0.f, ORANGE,  // Left
-    0.f, 0.f, GREEN,   0.f, 1.f, GREEN,   1.f, 1.f, GREEN,   1.f, 0.f, GREEN,   // Front
-    0.f, 0.f, BLACK,   0.f, 1.f, BLACK,   1.f, 1.f, BLACK,   1.f, 0.f, BLACK    // Back
-};
+cube_vertex vertices[NUM_CUBES * FACES_PER_CUBE * VERTEX_PER_FACE] = { 0 };
+unsigned short indices[NUM_CUBES * FACES_PER_CUBE * TRIANGLE_PER_FACE * INDEX_PER_TRIANGLE] = { 0 };
 
 static void generate_cube_vertices() {
-    int idx = 0;
+    int idx = 0, cubie = 0;
     int y = 2;
     while (--y >= -1) {
         int z = 2;
@@ -350,13 +181,18 @@ static void generate_cube_vertices() {
             int x = 2;
             while (--x >= -1) {
                 if ((x == 0) && (y == 0) && (z == 0)) continue;
-                // Copying single cube offsets to next cube, then applying offsets
-                memcpy(vertices + idx, single_cube_vertices, sizeof(single_cube_vertices));
-                int end_idx = idx + (int) sizeof(single_cube_vertices) / sizeof(float);
-                while (idx < end_idx) {
-                    vertices[idx++] += x;
-                    vertices[idx++] += y;
-                    vertices[idx++] += z;
+                cubie_positions[cubie][0] = x;
+                cubie_positions[cubie][1] = y;
+                cubie_positions[cubie][2] = z;
+                cubie++;
+                // Single cube offset to this cube, scaled so the half unit corners pack into bytes
+                for (int v = 0; v < FACES_PER_CUBE * VERTEX_PER_FACE; v++, idx++) {
+                    const float *corner = single_cube_vertices + v * VERTEX_SIZE;
+                    vertices[idx].position[0] = (int8_t)((corner[0] + (float)x) * CUBE_POSITION_SCALE);
+                    vertices[idx].position[1] = (int8_t)((corner[1] + (float)y) * CUBE_POSITION_SCALE);
+                    vertices[idx].position[2] = (int8_t)((corner[2] + (float)z) * CUBE_POSITION_SCALE);
+                    vertices[idx].tex_coord[0] = single_face_tex_coords[v % VERTEX_PER_FACE][0];
+                    vertices[idx].tex_coord[1] = single_face_tex_coords[v % VERTEX_PER_FACE][1];
                 }
             }
         }
@@ -374,8 +210,8 @@ static void generate_cube_indices() {
                 if ((x == 0) && (y == 0) && (z == 0)) continue;
                 // Copying single cube indices of next cube, then adding that cube's idx offset
                 memcpy(indices + idx, single_cube_indices, sizeof(single_cube_indices));
-                int end_idx = idx + (int) sizeof(single_cube_indices) / sizeof(float);
-                while (idx < end_idx) indices[idx++] += cube_idx_offset;
+                int end_idx = idx + (int) (sizeof(single_cube_indices) / sizeof(unsigned short));
+                while (idx < end_idx) indices[idx++] += (unsigned short)cube_idx_offset;
                 cube_idx_offset += FACES_PER_CUBE * VERTEX_PER_FACE;
             }
         }
@@ -390,28 +226,99 @@ quaternion *cube_orientation() {
     return &orientation;
 }
 
+void cube_update() {
+    tick_orientation[0] = tick_orientation[1];
+    tick_orientation[1] = orientation;
+}
+
+const quaternion *cube_tick_orientations() {
+    return tick_orientation;
+}
+
+const mat4 *cube_cubie_transforms() {
+    return cubie_transforms;
+}
+
+void cube_sticker_colours(unsigned char colours[NUM_CUBES * FACES_PER_CUBE]) {
+    memcpy(colours, sticker_colours, sizeof(sticker_colours));
+}
+
+const cube_state *cube_logical_state() {
+    return &logical_state;
+}
+
+void cube_cubie_position(int cubie, int position[3]) {
+    position[0] = -cubie_positions[cubie][0];
+    position[1] = cubie_positions[cubie][1];
+    position[2] = -cubie_positions[cubie][2];
+}
+
+void cube_frame_to_world(const int v[3], vec3 world) {
+    world[0] = (float)-v[0];
+    world[1] = (float)v[1];
+    world[2] = (float)-v[2];
+}
+
+void cube_set_cubie_transform(int cubie, const mat4 transform) {
+    mat_copy(cubie_transforms[cubie], transform);
+}
+
+static void update_sticker_colours() {
+    char facelets[NUM_FACELETS];
+    cube_state_to_facelets(&logical_state, facelets);
+    for (int face = 0; face < NUM_CUBES * FACES_PER_CUBE; face++) {
+        int facelet = face_facelets[face];
+        if (facelet < 0) {
+            sticker_colours[face] = BLACK;
+            continue;
+        }
+        int colour = 0;
+        while ((colour < NUM_FACES) && ("URFDLB"[colour] != facelets[facelet])) colour++;
+        sticker_colours[face] = face_colour[colour];
+    }
+}
+
+void cube_commit_move(uint8_t move) {
+    cube_state_apply_move(&logical_state, move);
+    update_sticker_colours();
+    for (int i = 0; i < NUM_CUBES; i++) ident(cubie_transforms[i]);
+}
+
 void cube_init_data() {
     pos[0] = 0;
     pos[1] = 0;
     pos[2] = 0;
 
     orientation = quaternion_create((vec3) { 0, 1, 0 }, 0.f);
+    tick_orientation[0] = orientation;
+    tick_orientation[1] = orientation;
+    for (int i = 0; i < NUM_CUBES; i++) ident(cubie_transforms[i]);
 
     generate_cube_vertices();
     generate_cube_indices();
+
+    // Which facelet each cubie face shows, found once so colour updates are a lookup
+    cube_state_init();
+    cube_state_solved(&logical_state);
+    for (int cubie = 0; cubie < NUM_CUBES; cubie++) {
+        int position[3], normal[3];
+        cube_cubie_position(cubie, position);
+        for (int face = 0; face < FACES_PER_CUBE; face++) {
+            normal[0] = -mesh_face_normal[face][0];
+            normal[1] = mesh_face_normal[face][1];
+            normal[2] = -mesh_face_normal[face][2];
+            face_facelets[cubie * FACES_PER_CUBE + face] = cube_state_facelet_at(position, normal);
+        }
+    }
+    update_sticker_colours();
 }
 
-float *cube_vertex_info(int *size) {
+cube_vertex *cube_vertex_info(int *size) {
     *size = (int)sizeof(vertices);
     return vertices;
 }
 
-unsigned int *cube_index_info(int *size) {
+unsigned short *cube_index_info(int *size) {
     *size = (int)sizeof(indices);
     return indices;
 }
-
-float *cube_texture_info(int *size) {
-    *size = (int)sizeof(texture_info);
-    return texture_info;
-}
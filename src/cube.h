@@ -1,22 +1,65 @@
 #ifndef CUBE_H
 #define CUBE_H
 
+#include <stdint.h>
+
 #include "vector.h"
 #include "quaternion.h"
+#include "cube_state.h"
+
+#define NUM_CUBES 26
+#define FACES_PER_CUBE 6
+
+// Mesh positions are stored multiplied by this, which makes the half unit cubie corners small integers
+#define CUBE_POSITION_SCALE 2
+
+// Static part of a mesh vertex, 8 bytes. Sticker colours change as the cube turns, so they are kept apart
+typedef struct {
+    int8_t position[4];     // x, y, z times CUBE_POSITION_SCALE, w unused to keep the stride aligned
+    uint8_t tex_coord[2];   // u, v as normalized unsigned bytes
+    uint8_t padding[2];
+} cube_vertex;
 
 vec3 *cube_pos();
 quaternion* cube_orientation();
 
-// Sets up cube data (vertex, index, texture)
-void cube_init_data();
+// Fixed-timestep simulation step, records the orientation reached this step
+void cube_update();
+
+// Orientation at the previous and latest simulation step, for interpolating between them
+const quaternion *cube_tick_orientations();
+
+// Transform of each cubie relative to the cube (cube_vertex_info already places cubies at their offsets)
+const mat4 *cube_cubie_transforms();
 
-// Get cube vertex data and size
-float *cube_vertex_info(int *size);
+// Colour index of each cubie face, in cube_vertex_info order
+void cube_sticker_colours(unsigned char colours[NUM_CUBES * FACES_PER_CUBE]);
+
+// Which way the stickers are arranged, the state every committed move has been applied to
+const cube_state *cube_logical_state();
+
+/*
+* cube_cubie_position: Where a cubie of the mesh sits, coordinates -1 to 1 in the cube_state frame (x right, y up,
+* z towards a viewer facing F). The mesh is built facing the camera on -z, so that is the world's (-x, y, -z).
+*/
+void cube_cubie_position(int cubie, int position[3]);
+
+// Direction in the cube_state frame as a direction in the cube's model space
+void cube_frame_to_world(const int v[3], vec3 world);
+
+// Sets a cubie's transform relative to the cube, to show it part way through a turn
+void cube_set_cubie_transform(int cubie, const mat4 transform);
+
+// Applies a move to the logical state, repaints the stickers to match and puts every cubie back in place
+void cube_commit_move(uint8_t move);
+
+// Sets up cube data (vertex, index, sticker colours)
+void cube_init_data();
 
-// Get cube index data and size
-unsigned int *cube_index_info(int *size);
+// Get cube vertex data and size, four vertices per cubie face in cube_sticker_colours order
+cube_vertex *cube_vertex_info(int *size);
 
-// Get cube texture data and size
-float *cube_texture_info(int *size);
+// Get cube index data and size, 16 bit as the mesh has fewer than 65536 vertices
+unsigned short *cube_index_info(int *size);
 
 #endif // !CUBE_H
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "cube_state.h"
+
+#include <string.h>
+
+static const char face_letters[NUM_FACES] = { 'U', 'R', 'F', 'D', 'L', 'B' };
+
+// Facelets of each corner and edge slot, the first being the one orientation is measured against
+static const uint8_t corner_facelet[NUM_CORNERS][3] = {
+    { 8, 9, 20 }, { 6, 18, 38 }, { 0, 36, 47 }, { 2, 45, 11 },
+    { 29, 26, 15 }, { 27, 44, 24 }, { 33, 53, 42 }, { 35, 17, 51 }
+};
+static const uint8_t edge_facelet[NUM_EDGES][2] = {
+    { 5, 10 }, { 7, 19 }, { 3, 37 }, { 1, 46 }, { 32, 16 }, { 28, 25 },
+    { 30, 43 }, { 34, 52 }, { 23, 12 }, { 21, 41 }, { 50, 39 }, { 48, 14 }
+};
+
+// Faces each cubie's colours belong to, in the same order as the facelets of its home slot
+static const uint8_t corner_colour[NUM_CORNERS][3] = {
+    { FACE_U, FACE_R, FACE_F }, { FACE_U, FACE_F, FACE_L }, { FACE_U, FACE_L, FACE_B }, { FACE_U, FACE_B, FACE_R },
+    { FACE_D, FACE_F, FACE_R }, { FACE_D, FACE_L, FACE_F }, { FACE_D, FACE_B, FACE_L }, { FACE_D, FACE_R, FACE_B }
+};
+static const uint8_t edge_colour[NUM_EDGES][2] = {
+    { FACE_U, FACE_R }, { FACE_U, FACE_F }, { FACE_U, FACE_L }, { FACE_U, FACE_B },
+    { FACE_D, FACE_R }, { FACE_D, FACE_F }, { FACE_D, FACE_L }, { FACE_D, FACE_B },
+    { FACE_F, FACE_R }, { FACE_F, FACE_L }, { FACE_B, FACE_L }, { FACE_B, FACE_R }
+};
+
+/*
+* Facelet geometry, in cubie coordinates (x right, y up, z towards the viewer). Facelet r * 3 + c of a face sits on
+* the cubie at normal + (c - 1) * column + (r - 1) * row.
+*/
+static const int face_normal[NUM_FACES][3] = { { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, -1, 0 }, { -1, 0, 0 }, { 0, 0, -1 } };
+static const int face_column[NUM_FACES][3] = { { 1, 0, 0 }, { 0, 0, -1 }, { 1, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { -1, 0, 0 } };
+static const int face_row[NUM_FACES][3] = { { 0, 0, 1 }, { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, -1 }, { 0, -1, 0 }, { 0, -1, 0 } };
+
+// Layers each move kind turns: those whose depth along the face normal lies in [min_depth, max_depth]
+static const struct {
+    uint8_t face;
+    signed char min_depth;
+    signed char max_depth;
+} move_layers[NUM_MOVE_KINDS] = {
+    { FACE_U, 1, 1 }, { FACE_R, 1, 1 }, { FACE_F, 1, 1 }, { FACE_D, 1, 1 }, { FACE_L, 1, 1 }, { FACE_B, 1, 1 },
+    { FACE_U, 0, 1 }, { FACE_R, 0, 1 }, { FACE_F, 0, 1 }, { FACE_D, 0, 1 }, { FACE_L, 0, 1 }, { FACE_B, 0, 1 },
+    { FACE_L, 0, 0 }, { FACE_D, 0, 0 }, { FACE_F, 0, 0 },
+    { FACE_R, -1, 1 }, { FACE_U, -1, 1 }, { FACE_F, -1, 1 }
+};
+
+#define NUM_ORIENTATIONS 24
+
+static cube_state move_table[NUM_MOVES];
+static uint8_t orientations[NUM_ORIENTATIONS][NUM_FACES];
+static int initialized = 0;
+
+static int dot(const int a[3], const int b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Clockwise quarter turn about the outward axis: p' = axis (axis . p) - axis x p
+static void rotate(const int axis[3], const int p[3], int result[3]) {
+    int d = dot(axis, p);
+    result[0] = axis[0] * d - (axis[1] * p[2] - axis[2] * p[1]);
+    result[1] = axis[1] * d - (axis[2] * p[0] - axis[0] * p[2]);
+    result[2] = axis[2] * d - (axis[0] * p[1] - axis[1] * p[0]);
+}
+
+static void facelet_position(int facelet, int p[3]) {
+    int f = facelet / 9, r = facelet % 9 / 3, c = facelet % 3;
+    for (int i = 0; i < 3; i++) p[i] = face_normal[f][i] + (c - 1) * face_column[f][i] + (r - 1) * face_row[f][i];
+}
+
+int cube_state_facelet_at(const int p[3], const int normal[3]) {
+    for (int i = 0; i < NUM_FACELETS; i++) {
+        int q[3];
+        facelet_position(i, q);
+        if ((memcmp(face_normal[i / 9], normal, sizeof(q)) == 0) && (memcmp(p, q, sizeof(q)) == 0)) return i;
+    }
+    return -1;
+}
+
+// Recognises cubies by their colours, with faces given as indices rather than letters
+static int decode_facelets(const uint8_t facelets[NUM_FACELETS], cube_state *state) {
+    for (int i = 0; i < NUM_FACES; i++) state->centres[i] = facelets[i * 9 + 4];
+
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        int twist = 0;
+        while ((twist < 3) && (facelets[corner_facelet[i][twist]] != FACE_U) && (facelets[corner_facelet[i][twist]] != FACE_D)) twist++;
+        if (twist == 3) return 0;
+
+        uint8_t a = facelets[corner_facelet[i][(twist + 1) % 3]];
+        uint8_t b = facelets[corner_facelet[i][(twist + 2) % 3]];
+        int j = 0;
+        while ((j < NUM_CORNERS) && ((corner_colour[j][1] != a) || (corner_colour[j][2] != b))) j++;
+        if (j == NUM_CORNERS) return 0;
+        state->cp[i] = j;
+        state->co[i] = twist;
+    }
+
+    for (int i = 0; i < NUM_EDGES; i++) {
+        uint8_t a = facelets[edge_facelet[i][0]];
+        uint8_t b = facelets[edge_facelet[i][1]];
+        int j = 0;
+        while (j < NUM_EDGES) {
+            if ((edge_colour[j][0] == a) && (edge_colour[j][1] == b)) {
+                state->eo[i] = 0;
+                break;
+            }
+            if ((edge_colour[j][0] == b) && (edge_colour[j][1] == a)) {
+                state->eo[i] = 1;
+                break;
+            }
+            j++;
+        }
+        if (j == NUM_EDGES) return 0;
+        state->ep[i] = j;
+    }
+    return 1;
+}
+
+// Turns the layers of a move kind a quarter turn on the solved cube, following each facelet to its new place
+static void build_quarter_turn(int kind, cube_state *state) {
+    const int *axis = face_normal[move_layers[kind].face];
+    uint8_t facelets[NUM_FACELETS];
+
+    for (int i = 0; i < NUM_FACELETS; i++) {
+        int p[3];
+        facelet_position(i, p);
+        int depth = dot(axis, p);
+        if ((depth < move_layers[kind].min_depth) || (depth > move_layers[kind].max_depth)) {
+            facelets[i] = i / 9;
+            continue;
+        }
+
+        int moved[3], normal[3];
+        rotate(axis, p, moved);
+        rotate(axis, face_normal[i / 9], normal);
+        facelets[cube_state_facelet_at(moved, normal)] = i / 9;
+    }
+    decode_facelets(facelets, state);
+}
+
+// The 24 centre arrangements reachable by rotations, found by closing the solved one under x and y
+static void build_orientations() {
+    memcpy(orientations[0], (uint8_t[]){ FACE_U, FACE_R, FACE_F, FACE_D, FACE_L, FACE_B }, NUM_FACES);
+    int count = 1;
+    for (int i = 0; i < count; i++) {
+        for (int r = 0; r < 2; r++) {
+            const cube_state *rotation = &move_table[MOVE(r == 0 ? MOVE_X : MOVE_Y, 1)];
+            uint8_t next[NUM_FACES];
+            for (int f = 0; f < NUM_FACES; f++) next[f] = orientations[i][rotation->centres[f]];
+
+            int seen = 0;
+            for (int j = 0; j < count && !seen; j++) seen = memcmp(orientations[j], next, NUM_FACES) == 0;
+            if (!seen) memcpy(orientations[count++], next, NUM_FACES);
+        }
+    }
+}
+
+void cube_state_init() {
+    if (initialized) return;
+
+    for (int kind = 0; kind < NUM_MOVE_KINDS; kind++) {
+        build_quarter_turn(kind, &move_table[MOVE(kind, 1)]);
+        cube_state_multiply(&move_table[MOVE(kind, 1)], &move_table[MOVE(kind, 1)], &move_table[MOVE(kind, 2)]);
+        cube_state_multiply(&move_table[MOVE(kind, 2)], &move_table[MOVE(kind, 1)], &move_table[MOVE(kind, 3)]);
+    }
+    build_orientations();
+    initialized = 1;
+}
+
+void cube_state_solved(cube_state *state) {
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        state->cp[i] = i;
+        state->co[i] = 0;
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        state->ep[i] = i;
+        state->eo[i] = 0;
+    }
+    for (int i = 0; i < NUM_FACES; i++) state->centres[i] = i;
+}
+
+int cube_state_is_solved(const cube_state *state) {
+    cube_state solved;
+    cube_state_solved(&solved);
+    return memcmp(state, &solved, sizeof(solved)) == 0;
+}
+
+void cube_state_multiply(const cube_state *a, const cube_state *b, cube_state *result) {
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        uint8_t from = b->cp[i];
+        uint8_t twist = a->co[from] + b->co[i];
+        result->cp[i] = a->cp[from];
+        result->co[i] = (twist >= 3) ? twist - 3 : twist;
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        uint8_t from = b->ep[i];
+        result->ep[i] = a->ep[from];
+        result->eo[i] = a->eo[from] ^ b->eo[i];
+    }
+    for (int i = 0; i < NUM_FACES; i++) result->centres[i] = a->centres[b->centres[i]];
+}
+
+void cube_state_apply_move(cube_state *state, uint8_t move) {
+    cube_state result;
+    cube_state_multiply(state, &move_table[move], &result);
+    *state = result;
+}
+
+void cube_state_apply_moves(cube_state *state, const uint8_t *moves, size_t count) {
+    // Ping-pong between two buffers so each move is a single pass with no copy back
+    cube_state buffers[2];
+    buffers[0] = *state;
+    size_t i = 0;
+    for (; i < count; i++) cube_state_multiply(&buffers[i & 1], &move_table[moves[i]], &buffers[(i & 1) ^ 1]);
+    *state = buffers[i & 1];
+}
+
+const cube_state *cube_state_move(uint8_t move) {
+    return &move_table[move];
+}
+
+void cube_state_move_layers(uint8_t move, int normal[3], int *min_depth, int *max_depth) {
+    int kind = MOVE_KIND(move);
+    memcpy(normal, face_normal[move_layers[kind].face], sizeof(face_normal[0]));
+    *min_depth = move_layers[kind].min_depth;
+    *max_depth = move_layers[kind].max_depth;
+}
+
+void cube_state_to_facelets(const cube_state *state, char facelets[NUM_FACELETS]) {
+    for (int i = 0; i < NUM_FACES; i++) facelets[i * 9 + 4] = face_letters[state->centres[i]];
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        for (int k = 0; k < 3; k++) facelets[corner_facelet[i][(k + state->co[i]) % 3]] = face_letters[corner_colour[state->cp[i]][k]];
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        for (int k = 0; k < 2; k++) facelets[edge_facelet[i][(k + state->eo[i]) % 2]] = face_letters[edge_colour[state->ep[i]][k]];
+    }
+}
+
+int cube_state_from_facelets(const char facelets[NUM_FACELETS], cube_state *state) {
+    uint8_t faces[NUM_FACELETS];
+    for (int i = 0; i < NUM_FACELETS; i++) {
+        const char *letter = memchr(face_letters, facelets[i], NUM_FACES);
+        if (!letter) return 0;
+        faces[i] = letter - face_letters;
+    }
+    return decode_facelets(faces, state) && cube_state_is_valid(state);
+}
+
+int cube_state_reorient(cube_state *state, uint8_t *rotations) {
+    // No rotation, then each power of x, y and z
+    uint8_t candidates[10];
+    candidates[0] = 0xFF;
+    for (int i = 0; i < 9; i++) candidates[1 + i] = MOVE(MOVE_X + i / 3, 1 + i % 3);
+
+    for (int a = 0; a < 10; a++) {
+        for (int b = 0; b < 10; b++) {
+            cube_state rotated = *state;
+            if (candidates[a] != 0xFF) cube_state_apply_move(&rotated, candidates[a]);
+            if (candidates[b] != 0xFF) cube_state_apply_move(&rotated, candidates[b]);
+            if (memcmp(rotated.centres, orientations[0], NUM_FACES) != 0) continue;
+
+            int count = 0;
+            if (candidates[a] != 0xFF) rotations[count++] = candidates[a];
+            if (candidates[b] != 0xFF) rotations[count++] = candidates[b];
+            *state = rotated;
+            return count;
+        }
+    }
+    return 0;
+}
+
+// Parity of a permutation, by counting inversions
+static int permutation_parity(const uint8_t *p, int n) {
+    int parity = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) parity ^= p[i] > p[j];
+    }
+    return parity;
+}
+
+int cube_state_is_valid(const cube_state *state) {
+    unsigned int corners_seen = 0, edges_seen = 0, twist = 0, flip = 0;
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        if ((state->cp[i] >= NUM_CORNERS) || (state->co[i] >= 3)) return 0;
+        corners_seen |= 1u << state->cp[i];
+        twist += state->co[i];
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        if ((state->ep[i] >= NUM_EDGES) || (state->eo[i] >= 2)) return 0;
+        edges_seen |= 1u << state->ep[i];
+        flip += state->eo[i];
+    }
+    if ((corners_seen != (1u << NUM_CORNERS) - 1) || (edges_seen != (1u << NUM_EDGES) - 1)) return 0;
+    if ((twist % 3 != 0) || (flip % 2 != 0)) return 0;
+
+    int orientation = 0;
+    while ((orientation < NUM_ORIENTATIONS) && (memcmp(orientations[orientation], state->centres, NUM_FACES) != 0)) orientation++;
+    if (orientation == NUM_ORIENTATIONS) return 0;
+
+    // A quarter turn of any layer is an odd permutation of exactly two of corners, edges and centres
+    return (permutation_parity(state->cp, NUM_CORNERS) ^ permutation_parity(state->ep, NUM_EDGES) ^ permutation_parity(state->centres, NUM_FACES)) == 0;
+}
+
+// Finalizer of MurmurHash3, a bijection on 64 bits with full avalanche
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t cube_state_hash(const cube_state *state) {
+    uint64_t corners = 0, edges = 0;
+    for (int i = 0; i < NUM_CORNERS; i++) corners = (corners << 5) | ((uint64_t)state->cp[i] << 2) | state->co[i];
+    for (int i = 0; i < NUM_FACES; i++) corners = (corners << 3) | state->centres[i];
+    for (int i = 0; i < NUM_EDGES; i++) edges = (edges << 5) | ((uint64_t)state->ep[i] << 1) | state->eo[i];
+    return mix64(corners ^ mix64(edges));
+}
@@ -0,0 +1,102 @@
+#ifndef CUBE_STATE_H
+#define CUBE_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "moves.h"
+
+// Corner and edge slots, named by the faces they sit between
+typedef enum { CORNER_URF, CORNER_UFL, CORNER_ULB, CORNER_UBR, CORNER_DFR, CORNER_DLF, CORNER_DBL, CORNER_DRB, NUM_CORNERS } corner;
+typedef enum { EDGE_UR, EDGE_UF, EDGE_UL, EDGE_UB, EDGE_DR, EDGE_DF, EDGE_DL, EDGE_DB, EDGE_FR, EDGE_FL, EDGE_BL, EDGE_BR, NUM_EDGES } edge;
+typedef enum { FACE_U, FACE_R, FACE_F, FACE_D, FACE_L, FACE_B, NUM_FACES } face;
+
+#define NUM_FACELETS 54
+
+/*
+* Logical cube as a permutation of cubies. Slot i holds corner cp[i] twisted co[i] times clockwise, edge ep[i]
+* flipped eo[i] times and the centre of face centres[i] (centres only move under slice turns and rotations).
+* Orientation is measured against the U/D facelet of corners and the Kociemba reference facelet of edges.
+*/
+typedef struct {
+    uint8_t cp[NUM_CORNERS];
+    uint8_t co[NUM_CORNERS];
+    uint8_t ep[NUM_EDGES];
+    uint8_t eo[NUM_EDGES];
+    uint8_t centres[NUM_FACES];
+} cube_state;
+
+// Builds the move tables from the facelet geometry, call once before any other cube_state function
+void cube_state_init();
+
+void cube_state_solved(cube_state *state);
+
+int cube_state_is_solved(const cube_state *state);
+
+/*
+* cube_state_multiply: Composes two states, a followed by b
+*
+* @param[in] a: first state
+* @param[in] b: second state
+* @param[out] result: a then b, may not alias a or b
+*/
+void cube_state_multiply(const cube_state *a, const cube_state *b, cube_state *result);
+
+void cube_state_apply_move(cube_state *state, uint8_t move);
+
+// Applies a whole move sequence, as produced by moves_parse
+void cube_state_apply_moves(cube_state *state, const uint8_t *moves, size_t count);
+
+// State reached by applying a single move to the solved cube
+const cube_state *cube_state_move(uint8_t move);
+
+/*
+* cube_state_move_layers: Where a move turns, in the facelet geometry's frame (x right, y up, z towards a viewer
+* facing F). It turns the layers whose depth along the outward normal lies in [min_depth, max_depth],
+* 1 being the face itself, 0 the middle slice and -1 the opposite face, clockwise as seen from outside that face.
+*/
+void cube_state_move_layers(uint8_t move, int normal[3], int *min_depth, int *max_depth);
+
+// Facelet on the cubie at p (coordinates -1 to 1) facing along normal, in the same frame, -1 if there is none
+int cube_state_facelet_at(const int p[3], const int normal[3]);
+
+/*
+* cube_state_to_facelets: Writes the 54 facelets in URFDLB face order, each face row by row as seen from outside
+* with U above F, R, L, B and F above D. Each facelet is the letter of the face its colour belongs to.
+*
+* @param[in] state: cube to read
+* @param[out] facelets: 54 characters, not null terminated
+*/
+void cube_state_to_facelets(const cube_state *state, char facelets[NUM_FACELETS]);
+
+/*
+* cube_state_from_facelets: Reads facelets written in the cube_state_to_facelets layout
+*
+* @param[in] facelets: 54 face letters
+* @param[out] state: decoded cube
+*
+* @return 1 if every cubie was recognised and the result is reachable by moves, 0 otherwise
+*/
+int cube_state_from_facelets(const char facelets[NUM_FACELETS], cube_state *state);
+
+/*
+* cube_state_reorient: Applies up to two rotations (x, y, z and their powers) bringing the centres home, so that
+* solvers working with face turns only can take over
+*
+* @param[in,out] state: cube to rotate
+* @param[out] rotations: the rotations applied, room for 2
+*
+* @return Number of rotations applied
+*/
+int cube_state_reorient(cube_state *state, uint8_t *rotations);
+
+// Checks every cubie appears once and twist, flip and permutation parity are those of a reachable cube
+int cube_state_is_valid(const cube_state *state);
+
+/*
+* cube_state_hash: 64-bit hash of a state, for hash tables. The state is packed without loss into two words (58
+* and 60 bits) which are then mixed, so every bit of the hash depends on every cubie.
+*/
+uint64_t cube_state_hash(const cube_state *state);
+
+#endif // !CUBE_STATE_H
@@ -0,0 +1,90 @@
+#include "headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glad/gl.h>
+
+#include "renderer.h"
+#include "offscreen.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "telemetry.h"
+#include "capture.h"
+#include "timer.h"
+#include "cube.h"
+#include "quaternion.h"
+
+// Spin applied every frame so consecutive frames differ
+#define SPIN_AXIS (vec3){ 1.f, 2.f, 0.5f }
+#define SPIN_PER_FRAME 0.01f
+
+static int should_dump(const char *dump_frames, int frame);
+
+int headless_run(const headless_options *options) {
+    simulation_init();
+    if (!simulation_queue_moves(options->moves, options->solve)) return 0;
+    if (!renderer_init()) return 0;
+    if (!offscreen_init(options->width, options->height)) return 0;
+    if (!telemetry_init()) return 0;
+    // One simulation step per frame, so the video plays back in real time at the simulation rate
+    if (!capture_start(options->width, options->height, UPDATES_PER_SECOND)) return 0;
+
+    quaternion spin = quaternion_create(SPIN_AXIS, SPIN_PER_FRAME);
+    uint64_t dump_ns = 0;
+    int dumped = 0;
+
+    uint64_t start = timer_now_ns();
+    for (int frame = 0; frame < options->frames; frame++) {
+        *cube_orientation() = quaternion_mul(spin, *cube_orientation());
+        simulation_step();
+        const frame_snapshot *snapshot = snapshot_read(NULL);
+
+        offscreen_bind();
+        telemetry_begin(PHASE_DRAW);
+        telemetry_gpu_begin();
+        draw(snapshot, 1.f);
+        telemetry_gpu_end();
+        telemetry_end(PHASE_DRAW);
+
+        capture_frame((uint64_t)frame * STEP_NS);
+
+        if (should_dump(options->dump_frames, frame)) {
+            // Readback stalls the pipeline, keep it out of the throughput figure
+            uint64_t dump_start = timer_now_ns();
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/frame_%05d.ppm", options->dump_dir ? options->dump_dir : ".", frame);
+            if (offscreen_write_ppm(path)) dumped++;
+            dump_ns += timer_now_ns() - dump_start;
+        }
+
+        telemetry_end_frame();
+    }
+    capture_stop();
+    glFinish();
+    uint64_t elapsed = timer_now_ns() - start - dump_ns;
+
+    double seconds = (double)elapsed / NS_PER_SEC;
+    printf("Rendered %d frames at %dx%d in %.3f s: %.1f fps\n", options->frames, options->width, options->height,
+        seconds, seconds > 0 ? options->frames / seconds : 0.0);
+    if (dumped) printf("Wrote %d frame(s)\n", dumped);
+    telemetry_report();
+
+    telemetry_cleanup();
+    offscreen_cleanup();
+    return 1;
+}
+
+static int should_dump(const char *dump_frames, int frame) {
+    if (dump_frames == NULL) return 0;
+    const char *p = dump_frames;
+    while (*p) {
+        char *end;
+        long n = strtol(p, &end, 10);
+        if (end == p) return 0;
+        if (n == frame) return 1;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#define HEADLESS_DEFAULT_WIDTH 800
+#define HEADLESS_DEFAULT_HEIGHT 600
+#define HEADLESS_DEFAULT_FRAMES 1000
+
+typedef struct {
+    int width;
+    int height;
+    int frames;                 // frames to render
+    const char *dump_frames;    // comma separated frame numbers to write to disk, NULL for none
+    const char *dump_dir;       // directory for dumped frames, NULL for the working directory
+    const char *moves;          // moves to animate, in Singmaster notation, NULL for none
+    int solve;                  // then animate a solution
+} headless_options;
+
+/*
+* headless_run: Renders a fixed number of frames into an offscreen framebuffer and reports throughput. Each frame
+* advances the simulation by exactly one step, turns the cube by a fixed amount and plays any queued moves, so runs
+* are deterministic and dumped frames can be compared pixel for pixel. Needs window_init_headless first.
+*
+* @param[in] options: what to render
+*
+* @return 1 if successful, 0 otherwise
+*/
+int headless_run(const headless_options *options);
+
+#endif // !HEADLESS_H
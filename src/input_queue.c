@@ -0,0 +1,34 @@
+#include "input_queue.h"
+
+// Power of two, enough for a 8kHz mouse between two 120Hz simulation steps with plenty to spare
+#define CAPACITY 1024
+#define MASK (CAPACITY - 1)
+
+// GLFW delivers callbacks on the thread that polls events, which is also the thread that drains, so no locking
+static input_event events[CAPACITY];
+static unsigned int head = 0, tail = 0;   // pop from head, push at tail
+static unsigned long dropped = 0;
+
+int input_queue_push(const input_event *event) {
+    if (tail - head == CAPACITY) {
+        input_event *last = &events[(tail - 1) & MASK];
+        if ((event->type == INPUT_CURSOR_MOVE) && (last->type == INPUT_CURSOR_MOVE)) {
+            *last = *event;
+            return 1;
+        }
+        dropped++;
+        return 0;
+    }
+    events[tail++ & MASK] = *event;
+    return 1;
+}
+
+int input_queue_pop(input_event *event) {
+    if (head == tail) return 0;
+    *event = events[head++ & MASK];
+    return 1;
+}
+
+unsigned long input_queue_dropped() {
+    return dropped;
+}
@@ -0,0 +1,38 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+typedef enum {
+    INPUT_CURSOR_MOVE,
+    INPUT_MOUSE_BUTTON
+} input_event_type;
+
+typedef struct {
+    input_event_type type;
+    double x, y;        // cursor position (INPUT_CURSOR_MOVE)
+    int button;         // INPUT_MOUSE_BUTTON
+    int action;         // INPUT_MOUSE_BUTTON, GLFW_PRESS or GLFW_RELEASE
+} input_event;
+
+/*
+* input_queue_push: Queues a raw input event. When the queue is full, a cursor move replaces a queued cursor move
+* at the tail (only the latest position matters) and anything else is dropped.
+*
+* @param[in] event: event to queue
+*
+* @return 1 if queued or coalesced, 0 if dropped
+*/
+int input_queue_push(const input_event *event);
+
+/*
+* input_queue_pop: Takes the oldest queued event
+*
+* @param[out] event: oldest event
+*
+* @return 1 if an event was taken, 0 if the queue is empty
+*/
+int input_queue_pop(input_event *event);
+
+// Number of events dropped because the queue was full
+unsigned long input_queue_dropped();
+
+#endif // !INPUT_QUEUE_H
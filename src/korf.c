@@ -0,0 +1,531 @@
+#include "korf.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "coordinates.h"
+#include "pruning_table.h"
+#include "timer.h"
+#include "thread.h"
+
+#define EDGE_GROUP_SIZE 6
+#define NUM_EDGE_FLIPS 64
+#define DEADLINE_CHECK_NODES (1 << 16)
+#define MAX_THREADS 64
+
+// Corner permutation and twist after each face turn
+static uint16_t corner_perm_move[NUM_CORNER_PERMS * NUM_FACE_MOVES];
+static uint16_t twist_move[NUM_TWISTS * NUM_FACE_MOVES];
+
+// Slot each edge slot's cubie moves to under each face turn, and whether it is flipped on arrival
+static uint8_t edge_destination[NUM_FACE_MOVES][NUM_EDGES];
+static uint8_t edge_flip[NUM_FACE_MOVES][NUM_EDGES];
+
+static pruning_table corner_depth;
+static pruning_table edge_depth[2];
+static coord_product corner_product;
+
+// First edge of each group, as context for the edge space
+static const uint8_t edge_group_first[2] = { EDGE_UR, EDGE_DL };
+
+static int initialized = 0;
+
+enum search_status {
+    SEARCH_RUNNING,
+    SEARCH_FOUND,
+    SEARCH_TIMED_OUT
+};
+
+typedef struct {
+    uint8_t moves[KORF_MAX_LENGTH];
+    uint64_t nodes;
+    uint64_t deadline_ns;
+    atomic_int *status;     // shared by every thread searching the same cube, any of them can stop the rest
+} search;
+
+// Where each edge cubie is and how it is flipped, the form the edge databases are indexed from
+typedef struct {
+    uint8_t slot[NUM_EDGES];
+    uint8_t flip[NUM_EDGES];
+} edge_places;
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define popcount(x) __popcnt(x)
+#else
+#define popcount(x) __builtin_popcount(x)
+#endif
+
+/*
+* Index of one edge group: the slots of its six cubies as a partial permutation (12 * 11 * ... * 7 choices), then
+* their flips as six bits
+*/
+static uint32_t edge_group_index(const edge_places *edges, int first) {
+    uint32_t rank = 0, flips = 0;
+    unsigned int used = 0;
+    for (int i = 0; i < EDGE_GROUP_SIZE; i++) {
+        unsigned int slot = edges->slot[first + i];
+        unsigned int lower_free = slot - (unsigned int)popcount(used & ((1u << slot) - 1));
+        rank = rank * (unsigned int)(NUM_EDGES - i) + lower_free;
+        used |= 1u << slot;
+        flips = flips * 2 + edges->flip[first + i];
+    }
+    return rank * NUM_EDGE_FLIPS + flips;
+}
+
+static void edge_group_places(uint32_t index, int first, edge_places *edges) {
+    uint32_t flips = index % NUM_EDGE_FLIPS;
+    uint32_t rank = index / NUM_EDGE_FLIPS;
+    unsigned int digits[EDGE_GROUP_SIZE];
+    for (int i = EDGE_GROUP_SIZE - 1; i >= 0; i--) {
+        digits[i] = rank % (unsigned int)(NUM_EDGES - i);
+        rank /= (unsigned int)(NUM_EDGES - i);
+        edges->flip[first + i] = flips & 1;
+        flips >>= 1;
+    }
+
+    unsigned int used = 0;
+    for (int i = 0; i < EDGE_GROUP_SIZE; i++) {
+        unsigned int slot = 0, free_seen = 0;
+        for (;; slot++) {
+            if (used & (1u << slot)) continue;
+            if (free_seen++ == digits[i]) break;
+        }
+        used |= 1u << slot;
+        edges->slot[first + i] = slot;
+    }
+}
+
+static void move_edges(const edge_places *edges, int move, int first, int count, edge_places *result) {
+    for (int i = first; i < first + count; i++) {
+        uint8_t slot = edge_destination[move][edges->slot[i]];
+        result->slot[i] = slot;
+        result->flip[i] = edges->flip[i] ^ edge_flip[move][slot];
+    }
+}
+
+static void edge_group_neighbours(const void *context, uint64_t index, uint64_t *next) {
+    int first = *(const uint8_t *)context;
+    edge_places edges, moved;
+    edge_group_places((uint32_t)index, first, &edges);
+    for (int m = 0; m < NUM_FACE_MOVES; m++) {
+        move_edges(&edges, m, first, EDGE_GROUP_SIZE, &moved);
+        next[m] = edge_group_index(&moved, first);
+    }
+}
+
+static void edge_places_from_state(const cube_state *state, edge_places *edges) {
+    for (int i = 0; i < NUM_EDGES; i++) {
+        edges->slot[state->ep[i]] = i;
+        edges->flip[state->ep[i]] = state->eo[i];
+    }
+}
+
+static int load_table(pruning_table *table, const coord_space *space, const char *name, const char *table_dir) {
+    if (table_dir == NULL) return pruning_table_generate(table, space, 4, 0, name);
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s.prune", table_dir, name);
+    return pruning_table_load(table, space, 4, path, pruning_table_key(name, space->size, 4), name);
+}
+
+int korf_init(const char *table_dir) {
+    if (initialized) return 1;
+    cube_state_init();
+
+    uint8_t moves[NUM_FACE_MOVES];
+    for (int m = 0; m < NUM_FACE_MOVES; m++) moves[m] = m;
+    coord_move_table(corner_perm_move, NUM_CORNER_PERMS, coord_corner_perm, coord_set_corner_perm, moves, NUM_FACE_MOVES);
+    coord_move_table(twist_move, NUM_TWISTS, coord_twist, coord_set_twist, moves, NUM_FACE_MOVES);
+
+    for (int m = 0; m < NUM_FACE_MOVES; m++) {
+        const cube_state *move = cube_state_move(m);
+        for (int i = 0; i < NUM_EDGES; i++) {
+            edge_destination[m][move->ep[i]] = i;
+            edge_flip[m][i] = move->eo[i];
+        }
+    }
+
+    corner_product = (coord_product){ 2, NUM_FACE_MOVES, { NUM_CORNER_PERMS, NUM_TWISTS }, { corner_perm_move, twist_move } };
+    coord_space corners;
+    coord_product_space(&corner_product, &corners);
+    if (!load_table(&corner_depth, &corners, "korf_corners", table_dir)) return 0;
+
+    cube_state solved;
+    cube_state_solved(&solved);
+    edge_places solved_edges;
+    edge_places_from_state(&solved, &solved_edges);
+    for (int g = 0; g < 2; g++) {
+        coord_space edges = { KORF_EDGE_STATES, edge_group_index(&solved_edges, edge_group_first[g]), NUM_FACE_MOVES,
+            edge_group_neighbours, &edge_group_first[g] };
+        if (!load_table(&edge_depth[g], &edges, g == 0 ? "korf_edges_a" : "korf_edges_b", table_dir)) return 0;
+    }
+
+    initialized = 1;
+    return 1;
+}
+
+static unsigned int estimate(uint64_t corner_index, uint32_t edges_a, uint32_t edges_b) {
+    unsigned int h = pruning_table_get(&corner_depth, corner_index);
+    unsigned int a = pruning_table_get(&edge_depth[0], edges_a);
+    unsigned int b = pruning_table_get(&edge_depth[1], edges_b);
+    if (a > h) h = a;
+    return (b > h) ? b : h;
+}
+
+static int stopped(const search *s) {
+    return atomic_load_explicit(s->status, memory_order_relaxed) != SEARCH_RUNNING;
+}
+
+static int out_of_time(search *s) {
+    if ((++s->nodes % DEADLINE_CHECK_NODES == 0) && s->deadline_ns && (timer_now_ns() > s->deadline_ns)) {
+        int running = SEARCH_RUNNING;
+        atomic_compare_exchange_strong(s->status, &running, SEARCH_TIMED_OUT);
+    }
+    return stopped(s);
+}
+
+// Children of a node that survive the redundancy and depth tests, with the indices they were tested on
+typedef struct {
+    int count;
+    uint8_t move[NUM_FACE_MOVES];
+    uint64_t corner_index[NUM_FACE_MOVES];
+    edge_places edges[NUM_FACE_MOVES];
+} children;
+
+/*
+* Successors come in move order, skipping those move_is_redundant rules out, so each sequence of commuting or
+* same-face turns is only tried in its canonical form. Every child's indices are computed and prefetched before any
+* is tested, so the cache misses overlap.
+*/
+static void expand(const search *s, unsigned int corners, unsigned int twist, const edge_places *edges, int depth,
+    int togo, children *result) {
+    uint32_t edge_index[2][NUM_FACE_MOVES];
+    for (int m = 0; m < NUM_FACE_MOVES; m++) {
+        if ((depth > 0) && move_is_redundant(s->moves[depth - 1], m)) continue;
+        result->corner_index[m] = (uint64_t)corner_perm_move[corners * NUM_FACE_MOVES + m] * NUM_TWISTS + twist_move[twist * NUM_FACE_MOVES + m];
+        move_edges(edges, m, 0, NUM_EDGES, &result->edges[m]);
+        edge_index[0][m] = edge_group_index(&result->edges[m], edge_group_first[0]);
+        edge_index[1][m] = edge_group_index(&result->edges[m], edge_group_first[1]);
+        pruning_table_prefetch(&corner_depth, result->corner_index[m]);
+        pruning_table_prefetch(&edge_depth[0], edge_index[0][m]);
+        pruning_table_prefetch(&edge_depth[1], edge_index[1][m]);
+    }
+
+    result->count = 0;
+    for (int m = 0; m < NUM_FACE_MOVES; m++) {
+        if ((depth > 0) && move_is_redundant(s->moves[depth - 1], m)) continue;
+        if (estimate(result->corner_index[m], edge_index[0][m], edge_index[1][m]) >= (unsigned int)togo) continue;
+        result->move[result->count++] = m;
+    }
+}
+
+// Depth-first search to exactly togo more moves
+static int search_node(search *s, unsigned int corners, unsigned int twist, const edge_places *edges, int depth, int togo) {
+    if (togo == 0) return 1;   // every database is at 0, so the cube is solved
+    if (out_of_time(s)) return 0;
+
+    children next;
+    expand(s, corners, twist, edges, depth, togo, &next);
+    for (int i = 0; i < next.count; i++) {
+        int m = next.move[i];
+        s->moves[depth] = m;
+        if (search_node(s, (unsigned int)(next.corner_index[m] / NUM_TWISTS), (unsigned int)(next.corner_index[m] % NUM_TWISTS),
+            &next.edges[m], depth + 1, togo - 1)) return 1;
+        if (stopped(s)) return 0;
+    }
+    return 0;
+}
+
+// -------------------------- Parallel search ---------------------------
+
+// A node at the split depth, searched to the end of the iteration by whichever worker gets it
+typedef struct {
+    uint8_t moves[KORF_MAX_SPLIT_DEPTH];
+    uint16_t corners;
+    uint16_t twist;
+    edge_places edges;
+} subtree;
+
+/*
+* Each worker owns a deque of subtrees, a range of the shared array. The owner takes from the back and thieves from
+* the front, so a steal takes the work furthest from what the owner is doing.
+*/
+typedef struct {
+    thread_mutex lock;
+    uint32_t front;
+    uint32_t back;
+} subtree_deque;
+
+typedef struct {
+    subtree *subtrees;
+    uint32_t num_subtrees;
+    uint32_t capacity;
+    subtree_deque deques[MAX_THREADS];
+    int num_workers;
+    int split_depth;
+    int bound;                  // iteration bound every worker searches to
+    uint64_t deadline_ns;
+    atomic_int status;
+    atomic_uint_fast64_t nodes;
+    uint8_t solution[KORF_MAX_LENGTH];
+
+    // Helper threads live for the whole solve and sleep between iterations
+    thread_mutex lock;
+    thread_cond work_ready;     // a new iteration was dealt out, or the pool is closing
+    thread_cond work_done;      // the last busy helper ran out of subtrees
+    unsigned int iteration;
+    int busy;
+    int closing;
+} parallel_search;
+
+typedef struct {
+    parallel_search *job;
+    int index;
+} worker;
+
+// Collects the nodes of this iteration at the split depth, pruning on the way down like the search itself
+static int collect_subtrees(parallel_search *p, search *s, unsigned int corners, unsigned int twist,
+    const edge_places *edges, int depth, int togo) {
+    if (depth == p->split_depth) {
+        if (p->num_subtrees == p->capacity) {
+            uint32_t capacity = p->capacity ? p->capacity * 2 : 1024;
+            subtree *grown = realloc(p->subtrees, capacity * sizeof(subtree));
+            if (grown == NULL) return 0;
+            p->subtrees = grown;
+            p->capacity = capacity;
+        }
+        subtree *t = &p->subtrees[p->num_subtrees++];
+        memcpy(t->moves, s->moves, (size_t)depth);
+        t->corners = (uint16_t)corners;
+        t->twist = (uint16_t)twist;
+        t->edges = *edges;
+        return 1;
+    }
+    s->nodes++;
+
+    children next;
+    expand(s, corners, twist, edges, depth, togo, &next);
+    for (int i = 0; i < next.count; i++) {
+        int m = next.move[i];
+        s->moves[depth] = m;
+        if (!collect_subtrees(p, s, (unsigned int)(next.corner_index[m] / NUM_TWISTS), (unsigned int)(next.corner_index[m] % NUM_TWISTS),
+            &next.edges[m], depth + 1, togo - 1)) return 0;
+    }
+    return 1;
+}
+
+// Takes the back of the worker's own deque, or failing that the front of another's
+static int next_subtree(parallel_search *p, int index, uint32_t *subtree_index) {
+    for (int i = 0; i < p->num_workers; i++) {
+        subtree_deque *deque = &p->deques[(index + i) % p->num_workers];
+        thread_mutex_lock(&deque->lock);
+        int taken = deque->front < deque->back;
+        if (taken) *subtree_index = (i == 0) ? --deque->back : deque->front++;
+        thread_mutex_unlock(&deque->lock);
+        if (taken) return 1;
+    }
+    return 0;
+}
+
+// Searches subtrees until every deque is empty or the search stops
+static void run_subtrees(parallel_search *p, int index) {
+    search s;
+    s.nodes = 0;
+    s.deadline_ns = p->deadline_ns;
+    s.status = &p->status;
+
+    uint32_t subtree_index;
+    while (!stopped(&s) && next_subtree(p, index, &subtree_index)) {
+        const subtree *t = &p->subtrees[subtree_index];
+        memcpy(s.moves, t->moves, (size_t)p->split_depth);
+        if (search_node(&s, t->corners, t->twist, &t->edges, p->split_depth, p->bound - p->split_depth)) {
+            // Only the first to finish writes its solution, the rest see the status and unwind
+            int running = SEARCH_RUNNING;
+            if (atomic_compare_exchange_strong(&p->status, &running, SEARCH_FOUND)) memcpy(p->solution, s.moves, (size_t)p->bound);
+        }
+    }
+    atomic_fetch_add(&p->nodes, s.nodes);
+}
+
+static void *subtree_worker(void *arg) {
+    const worker *w = arg;
+    parallel_search *p = w->job;
+    unsigned int seen = 0;
+    thread_mutex_lock(&p->lock);
+    for (;;) {
+        while ((p->iteration == seen) && !p->closing) thread_cond_wait(&p->work_ready, &p->lock);
+        if (p->closing) break;
+        seen = p->iteration;
+        thread_mutex_unlock(&p->lock);
+
+        run_subtrees(p, w->index);
+
+        thread_mutex_lock(&p->lock);
+        if (--p->busy == 0) thread_cond_signal(&p->work_done);
+    }
+    thread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/*
+* Searches one iteration on the pool, this thread taking worker 0's deque, or on this thread alone if there is
+* nothing worth splitting. The helpers are idle while the subtrees are collected, and idle again on return.
+*/
+static void search_iteration(parallel_search *p, int num_helpers, unsigned int corners, unsigned int twist,
+    const edge_places *edges) {
+    search s;
+    s.nodes = 0;
+    s.deadline_ns = p->deadline_ns;
+    s.status = &p->status;
+    p->num_subtrees = 0;
+    int collected = collect_subtrees(p, &s, corners, twist, edges, 0, p->bound);
+    atomic_fetch_add(&p->nodes, s.nodes);
+    if (!collected) {
+        if (search_node(&s, corners, twist, edges, 0, p->bound)) {
+            atomic_store(&p->status, SEARCH_FOUND);
+            memcpy(p->solution, s.moves, (size_t)p->bound);
+        }
+        return;
+    }
+
+    // Deal the subtrees out in contiguous runs, neighbouring subtrees share table entries near the root
+    for (int i = 0; i < p->num_workers; i++) {
+        p->deques[i].front = (uint32_t)((uint64_t)p->num_subtrees * (unsigned int)i / (unsigned int)p->num_workers);
+        p->deques[i].back = (uint32_t)((uint64_t)p->num_subtrees * (unsigned int)(i + 1) / (unsigned int)p->num_workers);
+    }
+
+    thread_mutex_lock(&p->lock);
+    p->iteration++;
+    p->busy = num_helpers;
+    thread_cond_broadcast(&p->work_ready);
+    thread_mutex_unlock(&p->lock);
+
+    run_subtrees(p, 0);
+
+    thread_mutex_lock(&p->lock);
+    while (p->busy > 0) thread_cond_wait(&p->work_done, &p->lock);
+    thread_mutex_unlock(&p->lock);
+}
+
+int korf_solve_parallel(const cube_state *state, int max_length, uint64_t time_budget_ns, int threads, int split_depth,
+    uint8_t *moves, korf_stats *stats) {
+    if (!cube_state_is_valid(state)) return -1;
+    if (max_length > KORF_MAX_LENGTH) max_length = KORF_MAX_LENGTH;
+    if (threads <= 0) threads = thread_cpu_count();
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (split_depth < 1) split_depth = 1;
+    if (split_depth > KORF_MAX_SPLIT_DEPTH) split_depth = KORF_MAX_SPLIT_DEPTH;
+
+    cube_state start = *state;
+    int num_rotations = cube_state_reorient(&start, moves);
+
+    parallel_search p;
+    p.subtrees = NULL;
+    p.num_subtrees = 0;
+    p.capacity = 0;
+    p.num_workers = threads;
+    for (int i = 0; i < threads; i++) thread_mutex_init(&p.deques[i].lock);
+    thread_mutex_init(&p.lock);
+    thread_cond_init(&p.work_ready);
+    thread_cond_init(&p.work_done);
+    p.iteration = 0;
+    p.busy = 0;
+    p.closing = 0;
+    uint64_t start_ns = timer_now_ns();
+    p.deadline_ns = time_budget_ns ? start_ns + time_budget_ns : 0;
+    atomic_init(&p.status, SEARCH_RUNNING);
+    atomic_init(&p.nodes, 0);
+
+    // Started once for the whole solve, this thread being worker 0. Deques without a thread are stolen from.
+    thread_handle helpers[MAX_THREADS];
+    worker workers[MAX_THREADS];
+    int num_helpers = 0;
+    for (int i = 1; i < threads; i++) {
+        workers[num_helpers] = (worker){ &p, i };
+        if (!thread_create(&helpers[num_helpers], subtree_worker, &workers[num_helpers])) break;
+        num_helpers++;
+    }
+
+    unsigned int corners = coord_corner_perm(&start);
+    unsigned int twist = coord_twist(&start);
+    edge_places edges;
+    edge_places_from_state(&start, &edges);
+
+    int depth = estimate((uint64_t)corners * NUM_TWISTS + twist, edge_group_index(&edges, edge_group_first[0]),
+        edge_group_index(&edges, edge_group_first[1]));
+    for (; depth <= max_length; depth++) {
+        p.bound = depth;
+        p.split_depth = (split_depth < depth) ? split_depth : depth;
+        search_iteration(&p, num_helpers, corners, twist, &edges);
+        if (atomic_load(&p.status) != SEARCH_RUNNING) break;
+    }
+
+    thread_mutex_lock(&p.lock);
+    p.closing = 1;
+    thread_cond_broadcast(&p.work_ready);
+    thread_mutex_unlock(&p.lock);
+    for (int i = 0; i < num_helpers; i++) thread_join(helpers[i]);
+
+    thread_cond_destroy(&p.work_done);
+    thread_cond_destroy(&p.work_ready);
+    thread_mutex_destroy(&p.lock);
+    for (int i = 0; i < threads; i++) thread_mutex_destroy(&p.deques[i].lock);
+    free(p.subtrees);
+
+    if (stats) {
+        stats->nodes = atomic_load(&p.nodes);
+        stats->elapsed_ns = timer_now_ns() - start_ns;
+        stats->nodes_per_second = stats->elapsed_ns ? (double)stats->nodes * NS_PER_SEC / (double)stats->elapsed_ns : 0.0;
+        stats->depth = (depth > max_length) ? max_length : depth;
+    }
+    if (atomic_load(&p.status) != SEARCH_FOUND) return -1;
+
+    memcpy(moves + num_rotations, p.solution, (size_t)depth);
+    return num_rotations + depth;
+}
+
+int korf_solve(const cube_state *state, int max_length, uint64_t time_budget_ns, uint8_t *moves, korf_stats *stats) {
+    if (!cube_state_is_valid(state)) return -1;
+    if (max_length > KORF_MAX_LENGTH) max_length = KORF_MAX_LENGTH;
+
+    cube_state start = *state;
+    int num_rotations = cube_state_reorient(&start, moves);
+
+    atomic_int status;
+    atomic_init(&status, SEARCH_RUNNING);
+    search s;
+    s.nodes = 0;
+    s.status = &status;
+    uint64_t start_ns = timer_now_ns();
+    s.deadline_ns = time_budget_ns ? start_ns + time_budget_ns : 0;
+
+    unsigned int corners = coord_corner_perm(&start);
+    unsigned int twist = coord_twist(&start);
+    edge_places edges;
+    edge_places_from_state(&start, &edges);
+
+    int length = -1;
+    int depth = estimate((uint64_t)corners * NUM_TWISTS + twist, edge_group_index(&edges, edge_group_first[0]),
+        edge_group_index(&edges, edge_group_first[1]));
+    for (; depth <= max_length; depth++) {
+        if (search_node(&s, corners, twist, &edges, 0, depth)) {
+            length = depth;
+            break;
+        }
+        if (stopped(&s)) break;
+    }
+
+    if (stats) {
+        stats->nodes = s.nodes;
+        stats->elapsed_ns = timer_now_ns() - start_ns;
+        stats->nodes_per_second = stats->elapsed_ns ? (double)s.nodes * NS_PER_SEC / (double)stats->elapsed_ns : 0.0;
+        stats->depth = (depth > max_length) ? max_length : depth;
+    }
+    if (length < 0) return -1;
+
+    memcpy(moves + num_rotations, s.moves, (size_t)length);
+    return num_rotations + length;
+}
@@ -0,0 +1,73 @@
+#ifndef KORF_H
+#define KORF_H
+
+#include <stdint.h>
+
+#include "cube_state.h"
+
+// Longest search depth, God's number plus a margin; the move array needs room for this plus two rotations
+#define KORF_MAX_LENGTH 24
+#define KORF_MAX_MOVES (KORF_MAX_LENGTH + 2)
+
+// Deepest the parallel search splits the tree at, 3 gives a few thousand subtrees, plenty to balance 64 threads
+#define KORF_MAX_SPLIT_DEPTH 6
+
+#define KORF_CORNER_STATES 88179840ull   // 8! corner permutations x 3^7 twists
+#define KORF_EDGE_STATES 42577920ull     // 12!/6! places for six edges x 2^6 flips
+
+typedef struct {
+    uint64_t nodes;         // nodes expanded
+    uint64_t elapsed_ns;
+    double nodes_per_second;
+    int depth;              // last depth bound searched
+} korf_stats;
+
+/*
+* Korf's optimal solver: IDA* over face turns, bounded below by the largest of three pattern databases, one for the
+* corners and one each for two disjoint groups of six edges (UR UF UL UB DR DF and DL DB FR FL BL BR). All three
+* hold 4-bit distances, about 86 MB together.
+*/
+
+/*
+* korf_init: Loads or generates the pattern databases. Generating takes minutes on one core and scales with cores,
+* so pass a table directory to do it once and share the mapped files between processes.
+*
+* @param[in] table_dir: directory for the table files, NULL to generate in memory
+*
+* @return 1 if successful, 0 if the tables couldn't be loaded or allocated
+*/
+int korf_init(const char *table_dir);
+
+/*
+* korf_solve: Finds a shortest face turn solution. If the centres aren't at home it starts with up to two
+* rotations bringing them there, which don't count towards the length.
+*
+* @param[in] state: cube to solve, cube_state_is_valid must hold
+* @param[in] max_length: deepest bound to search, at most KORF_MAX_LENGTH
+* @param[in] time_budget_ns: give up after this long, 0 for no limit
+* @param[out] moves: solution, room for KORF_MAX_MOVES
+* @param[out] stats: nodes searched and search speed, may be NULL
+*
+* @return Number of moves, -1 if the state is invalid or no solution was found within the limits
+*/
+int korf_solve(const cube_state *state, int max_length, uint64_t time_budget_ns, uint8_t *moves, korf_stats *stats);
+
+/*
+* korf_solve_parallel: korf_solve on a pool of threads, started once per solve with the calling thread among them.
+* Each iteration of the search is split into the subtrees below split_depth, dealt out to per-thread deques that
+* idle threads steal from, and stops on every thread as soon as one of them finds a solution. Which of several shortest solutions is returned can vary between runs.
+*
+* @param[in] state: cube to solve, cube_state_is_valid must hold
+* @param[in] max_length: deepest bound to search, at most KORF_MAX_LENGTH
+* @param[in] time_budget_ns: give up after this long, 0 for no limit
+* @param[in] threads: worker threads including the calling one, 0 for one per core
+* @param[in] split_depth: depth the iterations are split at, at most KORF_MAX_SPLIT_DEPTH
+* @param[out] moves: solution, room for KORF_MAX_MOVES
+* @param[out] stats: nodes searched across all threads and their combined speed, may be NULL
+*
+* @return Number of moves, -1 if the state is invalid or no solution was found within the limits
+*/
+int korf_solve_parallel(const cube_state *state, int max_length, uint64_t time_budget_ns, int threads, int split_depth,
+    uint8_t *moves, korf_stats *stats);
+
+#endif // !KORF_H
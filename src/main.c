@@ -1,40 +1,77 @@
-#include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "window.h"
-#include "renderer.h"
+#include "render_thread.h"
+#include "headless.h"
 #include "kernels.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "simulation.h"
+#include "capture.h"
 
-#define FPS 144
-#define MS_PER_UPDATE (1.0f / (FPS) * 1000)
+static int parse_args(int argc, char **argv, int *headless, headless_options *options);
 
-#ifdef _WIN32
-#include <windows.h>
-#define SLEEP_MS(ms) Sleep(ms)
-#else
-#include <unistd.h>
-#define SLEEP_MS(ms) usleep((ms) * 1000)
-#endif
+int main(int argc, char **argv) {
+    int headless = 0;
+    headless_options options = { HEADLESS_DEFAULT_WIDTH, HEADLESS_DEFAULT_HEIGHT, HEADLESS_DEFAULT_FRAMES, NULL, NULL, NULL, 0 };
+    if (!parse_args(argc, argv, &headless, &options)) return 1;
+
+    if (headless) {
+        int status = 1;
+        if (window_init_headless(options.width, options.height)) status = !headless_run(&options);
+        window_cleanup();
+        return status;
+    }
 
-int main() {
     if (!window_init()) goto cleanup;
-    if (!renderer_init()) goto cleanup;
     if (!cl_kernels_init()) goto cleanup;
-    
-    // Render loop
+
+    // Simulation state lives on this thread, the render thread only sees published snapshots of it
+    simulation_init();
+    if (!simulation_queue_moves(options.moves, options.solve)) goto cleanup;
+    if (!render_thread_start()) goto cleanup;
+
+    scheduler simulation_scheduler;
+    scheduler_init(&simulation_scheduler, UPDATES_PER_SECOND, UPDATES_PER_SECOND);
+
+    // Input & simulation loop
     // -------------------------------
     while (!window_should_close()) {
-        clock_t start = clock();
-        draw();
+        telemetry_begin(PHASE_POLL_EVENTS);
         poll_events();
-        swap_buffers();
-        clock_t dt = clock() - start;
-        int ms = dt / (CLOCKS_PER_SEC / 1000);
-        if (MS_PER_UPDATE > dt) SLEEP_MS(MS_PER_UPDATE - dt);
+        telemetry_end(PHASE_POLL_EVENTS);
+
+        int updates = scheduler_begin_frame(&simulation_scheduler);
+        while (updates-- > 0) simulation_step();
+
+        scheduler_end_frame(&simulation_scheduler);
     }
 
+    render_thread_stop();
+    scheduler_report(&simulation_scheduler);
+
     cleanup:
     window_cleanup();
 
     return 0;
 }
+
+static int parse_args(int argc, char **argv, int *headless, headless_options *options) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--headless")) *headless = 1;
+        else if (!strcmp(argv[i], "--frames") && (i + 1 < argc)) options->frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--size") && (i + 1 < argc)) sscanf(argv[++i], "%dx%d", &options->width, &options->height);
+        else if (!strcmp(argv[i], "--dump-frames") && (i + 1 < argc)) options->dump_frames = argv[++i];
+        else if (!strcmp(argv[i], "--dump-dir") && (i + 1 < argc)) options->dump_dir = argv[++i];
+        else if (!strcmp(argv[i], "--capture") && (i + 1 < argc)) capture_set_output(argv[++i]);
+        else if (!strcmp(argv[i], "--moves") && (i + 1 < argc)) options->moves = argv[++i];
+        else if (!strcmp(argv[i], "--solve")) options->solve = 1;
+        else {
+            printf("usage: %s [--moves NOTATION] [--solve] [--capture FILE.y4m|PNG_PREFIX] [--headless [--frames N] [--size WxH] [--dump-frames 0,10,...] [--dump-dir DIR]]\n", argv[0]);
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -8,30 +8,56 @@
 #include "cube.h"
 #include "quaternion.h"
 #include "ray.h"
+#include "input_queue.h"
 
 #define M_PI acos(-1.0)
 
-static double xpos, ypos, xvel, yvel;
+static double xpos, ypos;
 static int mouse_state[2] = { GLFW_RELEASE, GLFW_RELEASE }; // {lmb, rmb}
 
 static ray calculate_ray();
-static void rotate_cube();
+static void rotate_cube(double dx, double dy);
 static void rotate_face();
 
+// Callbacks only record the raw event, all the work happens once per simulation step in mouse_process_input
+
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
-	// button: GLFW_MOUSE_BUTTON_LEFT = 0, GLFW_MOUSE_BUTTON_RIGHT = 1
-	mouse_state[button] = action;
-	if (mouse_state[GLFW_MOUSE_BUTTON_LEFT] == GLFW_PRESS) {
-		ray r = calculate_ray();
-	}
+	input_event event = { .type = INPUT_MOUSE_BUTTON, .button = button, .action = action };
+	input_queue_push(&event);
 }
 
 void cursor_position_callback(GLFWwindow *window, double xpos_new, double ypos_new) {
-	xvel = xpos_new - xpos;
-	yvel = ypos_new - ypos;
-	xpos = xpos_new;
-	ypos = ypos_new;
-	if (mouse_state[GLFW_MOUSE_BUTTON_RIGHT] == GLFW_PRESS) rotate_cube();
+	input_event event = { .type = INPUT_CURSOR_MOVE, .x = xpos_new, .y = ypos_new };
+	input_queue_push(&event);
+}
+
+void mouse_process_input() {
+	// Cursor movement while rmb is held, summed over every event since the last step
+	double drag_x = 0, drag_y = 0;
+
+	input_event event;
+	while (input_queue_pop(&event)) {
+		switch (event.type) {
+		case INPUT_CURSOR_MOVE:
+			if (mouse_state[GLFW_MOUSE_BUTTON_RIGHT] == GLFW_PRESS) {
+				drag_x += event.x - xpos;
+				drag_y += event.y - ypos;
+			}
+			xpos = event.x;
+			ypos = event.y;
+			break;
+		case INPUT_MOUSE_BUTTON:
+			// button: GLFW_MOUSE_BUTTON_LEFT = 0, GLFW_MOUSE_BUTTON_RIGHT = 1
+			if ((event.button != GLFW_MOUSE_BUTTON_LEFT) && (event.button != GLFW_MOUSE_BUTTON_RIGHT)) break;
+			mouse_state[event.button] = event.action;
+			if (mouse_state[GLFW_MOUSE_BUTTON_LEFT] == GLFW_PRESS) {
+				ray r = calculate_ray();
+			}
+			break;
+		}
+	}
+
+	if ((drag_x != 0) || (drag_y != 0)) rotate_cube(drag_x, drag_y);
 }
 
 // https://antongerdelan.net/opengl/raycasting.html
@@ -55,16 +81,18 @@ static ray calculate_ray() {
 	return r;
 }
 
-static void rotate_cube() {
+// One rotation for the whole drag of a step, so the result doesn't depend on how many events the mouse sent
+static void rotate_cube(double dx, double dy) {
 	vec3 left, up, rotation_axis;
 	vec3_copy(left, *camera_left());
 	vec3_copy(up, *camera_up());
 
-	float mouse_movement_magnitude = vec3_norm((vec3) { xvel, yvel, 0 });
-	vec3_scale(xvel / mouse_movement_magnitude, up);
-	vec3_scale(-yvel / mouse_movement_magnitude, left);
+	// quaternion_create normalizes the axis, no need to divide by the magnitude here
+	vec3_scale((float)dx, up);
+	vec3_scale((float)-dy, left);
 	vec3_add(up, left, rotation_axis);
 
+	float mouse_movement_magnitude = (float)sqrt(dx * dx + dy * dy);
 	float mouse_movement_scaling_factor = 1.0 / 200.0;
 	*cube_orientation() = quaternion_mul(
 		quaternion_create(rotation_axis, mouse_movement_magnitude * mouse_movement_scaling_factor), 
@@ -6,5 +6,8 @@
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
 void cursor_position_callback(GLFWwindow *window, double xpos_new, double ypos_new);
 
+// Applies every mouse event queued since the last call. Call once per simulation step
+void mouse_process_input();
+
 
 #endif // !MOUSE_HANDLER_H
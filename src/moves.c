@@ -0,0 +1,204 @@
+#include "moves.h"
+
+#include <string.h>
+
+// Character classes, so that one table lookup per byte drives the parser. Anything not listed is invalid.
+#define NOT_A_MOVE 0
+#define IS_SEPARATOR 1
+#define IS_KIND(kind) ((kind) + 2)
+
+static const char *kind_names[NUM_MOVE_KINDS] = {
+    "U", "R", "F", "D", "L", "B",
+    "Uw", "Rw", "Fw", "Dw", "Lw", "Bw",
+    "M", "E", "S",
+    "x", "y", "z"
+};
+
+/*
+* Each axis has three layers: the U, R or F face, the slice and the opposite face. A kind turns each of them by a
+* signed number of quarter turns, clockwise as seen from the U, R or F side.
+*/
+static const struct {
+    uint8_t axis;
+    signed char layer[3];
+} kind_turns[NUM_MOVE_KINDS] = {
+    { 0, { 1, 0, 0 } }, { 1, { 1, 0, 0 } }, { 2, { 1, 0, 0 } },         // U R F
+    { 0, { 0, 0, -1 } }, { 1, { 0, 0, -1 } }, { 2, { 0, 0, -1 } },      // D L B
+    { 0, { 1, 1, 0 } }, { 1, { 1, 1, 0 } }, { 2, { 1, 1, 0 } },         // u r f
+    { 0, { 0, -1, -1 } }, { 1, { 0, -1, -1 } }, { 2, { 0, -1, -1 } },   // d l b
+    { 1, { 0, -1, 0 } }, { 0, { 0, -1, 0 } }, { 2, { 0, 1, 0 } },       // M E S
+    { 1, { 1, 1, 1 } }, { 0, { 1, 1, 1 } }, { 2, { 1, 1, 1 } }          // x y z
+};
+
+// Kinds that turn each axis, in kind order, which is the order a canonical run lists them in
+static const uint8_t axis_kinds[3][6] = {
+    { MOVE_U, MOVE_D, MOVE_UW, MOVE_DW, MOVE_E, MOVE_Y },
+    { MOVE_R, MOVE_L, MOVE_RW, MOVE_LW, MOVE_M, MOVE_X },
+    { MOVE_F, MOVE_B, MOVE_FW, MOVE_BW, MOVE_S, MOVE_Z }
+};
+
+static const unsigned char char_class[256] = {
+    [' '] = IS_SEPARATOR, ['\t'] = IS_SEPARATOR, ['\r'] = IS_SEPARATOR, ['\n'] = IS_SEPARATOR,
+    ['\v'] = IS_SEPARATOR, ['\f'] = IS_SEPARATOR, [','] = IS_SEPARATOR, ['.'] = IS_SEPARATOR,
+    [';'] = IS_SEPARATOR, ['('] = IS_SEPARATOR, [')'] = IS_SEPARATOR, ['['] = IS_SEPARATOR,
+    [']'] = IS_SEPARATOR, ['{'] = IS_SEPARATOR, ['}'] = IS_SEPARATOR,
+    ['U'] = IS_KIND(MOVE_U), ['R'] = IS_KIND(MOVE_R), ['F'] = IS_KIND(MOVE_F), ['D'] = IS_KIND(MOVE_D), ['L'] = IS_KIND(MOVE_L), ['B'] = IS_KIND(MOVE_B),
+    ['u'] = IS_KIND(MOVE_UW), ['r'] = IS_KIND(MOVE_RW), ['f'] = IS_KIND(MOVE_FW), ['d'] = IS_KIND(MOVE_DW), ['l'] = IS_KIND(MOVE_LW), ['b'] = IS_KIND(MOVE_BW),
+    ['M'] = IS_KIND(MOVE_M), ['E'] = IS_KIND(MOVE_E), ['S'] = IS_KIND(MOVE_S),
+    ['x'] = IS_KIND(MOVE_X), ['y'] = IS_KIND(MOVE_Y), ['z'] = IS_KIND(MOVE_Z)
+};
+
+long moves_parse(const char *text, size_t length, uint8_t *moves, size_t capacity, size_t *error_offset) {
+    const unsigned char *p = (const unsigned char *)text;
+    const unsigned char *end = p + length;
+    size_t count = 0;
+
+    while (p < end) {
+        unsigned char class = char_class[*p];
+        if (class == IS_SEPARATOR) {
+            p++;
+            continue;
+        }
+        if (class == NOT_A_MOVE) goto invalid;
+        unsigned char kind = class - IS_KIND(0);
+        p++;
+
+        // Uw is the same as u
+        if ((p < end) && (*p == 'w') && (kind <= MOVE_B)) {
+            kind += MOVE_UW;
+            p++;
+        }
+
+        // Count, then prime: R, R2, R', R2', R3 (= R')
+        unsigned int turns = 1;
+        if ((p < end) && (*p >= '0') && (*p <= '9')) turns = *p++ - '0';
+        if (p < end) {
+            if (*p == '\'') {
+                turns = 4 - turns % 4;
+                p++;
+            }
+            // U+2019 in UTF-8
+            else if ((end - p >= 3) && (p[0] == 0xE2) && (p[1] == 0x80) && (p[2] == 0x99)) {
+                turns = 4 - turns % 4;
+                p += 3;
+            }
+        }
+
+        // A move must be followed by a separator or the next move
+        if ((p < end) && (char_class[*p] == NOT_A_MOVE)) goto invalid;
+
+        turns %= 4;
+        if (turns == 0) continue;
+        if (count == capacity) {
+            // Past the end of the text, so callers can tell it from invalid notation
+            if (error_offset) *error_offset = length;
+            return -1;
+        }
+        moves[count++] = MOVE(kind, turns);
+    }
+    return (long)count;
+
+    invalid:
+    if (error_offset) *error_offset = (size_t)((const char *)p - text);
+    return -1;
+}
+
+size_t moves_format(const uint8_t *moves, size_t count, char *text, size_t capacity) {
+    static const char *suffixes[3] = { "", "2", "'" };
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        const char *name = kind_names[MOVE_KIND(moves[i])];
+        const char *suffix = suffixes[MOVE_POWER(moves[i]) - 1];
+        if (i > 0) {
+            if (length + 1 < capacity) text[length] = ' ';
+            length++;
+        }
+        for (const char *c = name; *c; c++, length++) if (length + 1 < capacity) text[length] = *c;
+        for (const char *c = suffix; *c; c++, length++) if (length + 1 < capacity) text[length] = *c;
+    }
+    text[(length < capacity) ? length : capacity - 1] = '\0';
+    return length;
+}
+
+/*
+* A run of same-axis turns packs into one byte: axis in the top two bits, then the net quarter turns of the three
+* layers two bits each. The run is the identity when the low six bits are zero.
+*/
+#define RUN(axis, top, middle, bottom) ((uint8_t)((axis) << 6 | ((top) & 3) << 4 | ((middle) & 3) << 2 | ((bottom) & 3)))
+#define RUN_AXIS(run) ((run) >> 6)
+#define RUN_LAYER(run, layer) (((run) >> (4 - 2 * (layer))) & 3)
+#define RUN_IS_IDENTITY(run) (((run) & 0x3F) == 0)
+
+// Adds power quarter turns of kind to a run on the same axis
+static uint8_t run_add(uint8_t run, int kind, int power) {
+    int layer[3];
+    for (int i = 0; i < 3; i++) layer[i] = RUN_LAYER(run, i) + kind_turns[kind].layer[i] * power;
+    return RUN(RUN_AXIS(run), layer[0], layer[1], layer[2]);
+}
+
+/*
+* Fewest moves giving each combination of net layer turns, indexed by the low six bits of a run. Entries hold the
+* quarter turns of the face, opposite face, wide face, wide opposite face, slice and rotation two bits each, in
+* the same clockwise-from-the-top units as runs. Found by exhaustive search, breaking ties towards face turns, then
+* slices, then wide turns, then rotations, so face-only input stays face-only.
+*/
+static const uint16_t run_moves[64] = {
+    0x000, 0x004, 0x008, 0x00c, 0x100, 0x040, 0x108, 0x10c,
+    0x200, 0x204, 0x080, 0x20c, 0x300, 0x304, 0x308, 0x0c0,
+    0x001, 0x005, 0x009, 0x00d, 0x010, 0x400, 0x018, 0x01c,
+    0x201, 0x050, 0x081, 0x20d, 0x301, 0x600, 0x090, 0x0c1,
+    0x002, 0x006, 0x00a, 0x00e, 0x102, 0x042, 0xb00, 0x0e0,
+    0x020, 0x024, 0x800, 0x02c, 0x302, 0x060, 0x900, 0x0c2,
+    0x003, 0x007, 0x00b, 0x00f, 0x103, 0x043, 0x0b0, 0xe00,
+    0x203, 0x207, 0x083, 0x0f0, 0x030, 0x034, 0x038, 0xc00,
+};
+
+// Expands a run into moves, returns how many (at most 3)
+static int run_emit(uint8_t run, uint8_t *moves) {
+    const uint8_t *kinds = axis_kinds[RUN_AXIS(run)];
+    uint16_t amounts = run_moves[run & 0x3F];
+    int count = 0;
+    for (int k = 0; k < 6; k++) {
+        int amount = (amounts >> (2 * k)) & 3;
+        if (amount == 0) continue;
+
+        // All layers a kind turns go the same way, clockwise or not as seen from the top
+        const signed char *layer = kind_turns[kinds[k]].layer;
+        int power = (layer[0] + layer[1] + layer[2] > 0) ? amount : 4 - amount;
+        moves[count++] = MOVE(kinds[k], power);
+    }
+    return count;
+}
+
+size_t moves_canonicalise(uint8_t *moves, size_t count) {
+    // The runs are stacked over the front of the array: there is never more of them than moves already read
+    size_t runs = 0;
+    for (size_t i = 0; i < count; i++) {
+        int kind = MOVE_KIND(moves[i]);
+        int axis = kind_turns[kind].axis;
+        if ((runs > 0) && (RUN_AXIS(moves[runs - 1]) == axis)) {
+            moves[runs - 1] = run_add(moves[runs - 1], kind, MOVE_POWER(moves[i]));
+            if (RUN_IS_IDENTITY(moves[runs - 1])) runs--;
+        }
+        else moves[runs++] = run_add(RUN(axis, 0, 0, 0), kind, MOVE_POWER(moves[i]));
+    }
+
+    // Runs never expand past the moves they came from, so writing back to front never overwrites an unread run
+    size_t total = 0;
+    uint8_t emitted[3];
+    for (size_t i = 0; i < runs; i++) total += run_emit(moves[i], emitted);
+
+    size_t end = total;
+    for (size_t i = runs; i-- > 0;) {
+        int n = run_emit(moves[i], emitted);
+        end -= n;
+        memcpy(moves + end, emitted, n);
+    }
+    return total;
+}
+
+int move_is_redundant(uint8_t prev, uint8_t next) {
+    int prev_kind = MOVE_KIND(prev), next_kind = MOVE_KIND(next);
+    if (kind_turns[prev_kind].axis != kind_turns[next_kind].axis) return 0;
+    return next_kind <= prev_kind;
+}
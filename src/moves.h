@@ -0,0 +1,78 @@
+#ifndef MOVES_H
+#define MOVES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Moves are stored one per byte: kind * 3 + (power - 1), where power is 1 (clockwise quarter turn), 2 (half turn)
+* or 3 (counter-clockwise quarter turn). Face turns come first in URFDLB order, so codes 0..17 are the usual
+* U U2 U' R R2 R' ... B' numbering used by solvers.
+*/
+typedef enum {
+    MOVE_U, MOVE_R, MOVE_F, MOVE_D, MOVE_L, MOVE_B,             // face turns
+    MOVE_UW, MOVE_RW, MOVE_FW, MOVE_DW, MOVE_LW, MOVE_BW,       // wide turns, face + adjacent slice
+    MOVE_M, MOVE_E, MOVE_S,                                     // slice turns, M follows L, E follows D, S follows F
+    MOVE_X, MOVE_Y, MOVE_Z,                                     // whole cube rotations, x follows R, y U, z F
+    NUM_MOVE_KINDS
+} move_kind;
+
+#define NUM_MOVES (NUM_MOVE_KINDS * 3)
+#define NUM_FACE_MOVES 18
+
+#define MOVE(kind, power) ((uint8_t)((kind) * 3 + (power) - 1))
+#define MOVE_KIND(move) ((move) / 3)
+#define MOVE_POWER(move) ((move) % 3 + 1)
+#define MOVE_INVERSE(move) ((uint8_t)((move) - (move) % 3 + 2 - (move) % 3))
+
+/*
+* moves_parse: Compiles Singmaster notation into move codes. Accepts face turns (U R F D L B), wide turns (Uw or u),
+* slices (M E S) and rotations (x y z), each optionally followed by a count and/or a prime (' or the typographic
+* right quote). Whitespace, commas, dots and brackets between moves are ignored.
+*
+* @param[in] text: notation to parse, need not be null terminated
+* @param[in] length: number of characters in text
+* @param[out] moves: move codes
+* @param[in] capacity: size of the moves array
+* @param[out] error_offset: offset of the first character that isn't valid notation, length if the notation is valid
+*     but has more than capacity moves, may be NULL
+*
+* @return Number of moves written, -1 on invalid notation or if there are more than capacity moves
+*/
+long moves_parse(const char *text, size_t length, uint8_t *moves, size_t capacity, size_t *error_offset);
+
+/*
+* moves_format: Writes move codes as space separated notation (wide turns as Uw)
+*
+* @param[in] moves: move codes
+* @param[in] count: number of moves
+* @param[out] text: null terminated notation, truncated to fit
+* @param[in] capacity: size of text, at least 1
+*
+* @return Length of the full notation, excluding the terminator (may exceed capacity - 1 if truncated)
+*/
+size_t moves_format(const uint8_t *moves, size_t count, char *text, size_t capacity);
+
+/*
+* moves_canonicalise: Rewrites a move sequence in place into its shortest same-axis form. Each run of turns about one
+* axis is folded into net quarter turns per layer and re-emitted with the fewest moves, in increasing kind order
+* (so D U becomes U D and R R R becomes R'). Runs that cancel out are dropped, letting their neighbours merge, as
+* in R U U' R'. Linear in the number of moves.
+*
+* @param[in,out] moves: move codes
+* @param[in] count: number of moves
+*
+* @return Number of moves left
+*/
+size_t moves_canonicalise(uint8_t *moves, size_t count);
+
+/*
+* move_is_redundant: Search pruning rule matching moves_canonicalise. Same-axis moves only appear in increasing kind
+* order with each kind at most once, so next is redundant after prev if it turns about the same axis and doesn't
+* come after it in that order.
+*
+* @return 1 if no canonical sequence has next directly after prev, 0 otherwise
+*/
+int move_is_redundant(uint8_t prev, uint8_t next);
+
+#endif // !MOVES_H
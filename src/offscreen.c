@@ -0,0 +1,69 @@
+#include "offscreen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glad/gl.h>
+
+static unsigned int FBO, colour_RBO, depth_RBO;
+static int fwidth, fheight;
+
+int offscreen_init(int width, int height) {
+    fwidth = width; fheight = height;
+
+    glGenFramebuffers(1, &FBO);
+    glGenRenderbuffers(1, &colour_RBO);
+    glGenRenderbuffers(1, &depth_RBO);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colour_RBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_RBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour_RBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_RBO);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Offscreen framebuffer incomplete\n");
+        return 0;
+    }
+    glViewport(0, 0, width, height);
+    return 1;
+}
+
+void offscreen_cleanup() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteRenderbuffers(1, &colour_RBO);
+    glDeleteRenderbuffers(1, &depth_RBO);
+}
+
+void offscreen_bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+}
+
+int offscreen_write_ppm(const char *path) {
+    int row_size = fwidth * 3;
+    unsigned char *pixels = malloc((size_t)row_size * fheight);
+    if (pixels == NULL) return 0;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, fwidth, fheight, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror("offscreen_write_ppm");
+        free(pixels);
+        return 0;
+    }
+
+    // GL rows start at the bottom, PPM rows at the top
+    fprintf(file, "P6\n%d %d\n255\n", fwidth, fheight);
+    for (int row = fheight - 1; row >= 0; row--) fwrite(pixels + (size_t)row * row_size, 1, row_size, file);
+
+    fclose(file);
+    free(pixels);
+    return 1;
+}
@@ -0,0 +1,28 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+/*
+* offscreen_init: Creates a framebuffer object with an RGBA8 colour and a depth attachment to render into instead
+* of the window
+*
+* @param[in] width, height: framebuffer size in pixels
+*
+* @return 1 if the framebuffer is complete, 0 otherwise
+*/
+int offscreen_init(int width, int height);
+void offscreen_cleanup();
+
+// Makes the offscreen framebuffer the render target
+void offscreen_bind();
+
+/*
+* offscreen_write_ppm: Reads back the framebuffer and writes it as a binary PPM, top row first. Blocks until the
+* GPU has finished rendering.
+*
+* @param[in] path: file to write
+*
+* @return 1 if successful, 0 otherwise
+*/
+int offscreen_write_ppm(const char *path);
+
+#endif // !OFFSCREEN_H
@@ -0,0 +1,171 @@
+#include "pocket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "coordinates.h"
+#include "pruning_table.h"
+
+#define POCKET_CORNERS 7        // every corner but DBL
+#define POCKET_PERMS 5040       // 7!
+#define POCKET_TWISTS 729       // 3^6, the last corner's twist follows from the others
+#define NUM_POCKET_MOVES 9      // U, R and F turns, which leave DBL alone
+
+static uint16_t perm_move[POCKET_PERMS * NUM_POCKET_MOVES];
+static uint16_t twist_move[POCKET_TWISTS * NUM_POCKET_MOVES];
+static coord_product product;
+static pruning_table distance;
+
+static int initialized = 0;
+
+// Slots in coordinate order, DBL left out
+static const uint8_t pocket_slots[POCKET_CORNERS] = {
+    CORNER_URF, CORNER_UFL, CORNER_ULB, CORNER_UBR, CORNER_DFR, CORNER_DLF, CORNER_DRB
+};
+
+// Corner numbering with DBL taken out, so the other seven are 0..6
+static uint8_t pocket_number(uint8_t corner) {
+    return (corner > CORNER_DBL) ? corner - 1 : corner;
+}
+
+static unsigned int pocket_perm(const cube_state *state) {
+    uint8_t p[POCKET_CORNERS];
+    for (int i = 0; i < POCKET_CORNERS; i++) p[i] = pocket_number(state->cp[pocket_slots[i]]);
+    return permutation_rank(p, POCKET_CORNERS);
+}
+
+static void pocket_set_perm(cube_state *state, unsigned int rank) {
+    uint8_t p[POCKET_CORNERS];
+    permutation_unrank(rank, p, POCKET_CORNERS);
+    for (int i = 0; i < POCKET_CORNERS; i++) state->cp[pocket_slots[i]] = pocket_slots[p[i]];
+    state->cp[CORNER_DBL] = CORNER_DBL;
+}
+
+static unsigned int pocket_twist(const cube_state *state) {
+    unsigned int twist = 0;
+    for (int i = 0; i < POCKET_CORNERS - 1; i++) twist = twist * 3 + state->co[pocket_slots[i]];
+    return twist;
+}
+
+static void pocket_set_twist(cube_state *state, unsigned int twist) {
+    unsigned int total = 0;
+    for (int i = POCKET_CORNERS - 2; i >= 0; i--) {
+        state->co[pocket_slots[i]] = twist % 3;
+        total += twist % 3;
+        twist /= 3;
+    }
+    state->co[pocket_slots[POCKET_CORNERS - 1]] = (3 - total % 3) % 3;
+    state->co[CORNER_DBL] = 0;
+}
+
+int pocket_init(const char *table_dir) {
+    if (initialized) return 1;
+    cube_state_init();
+
+    uint8_t moves[NUM_POCKET_MOVES];
+    for (int m = 0; m < NUM_POCKET_MOVES; m++) moves[m] = MOVE(MOVE_U + m / 3, 1 + m % 3);
+    coord_move_table(perm_move, POCKET_PERMS, pocket_perm, pocket_set_perm, moves, NUM_POCKET_MOVES);
+    coord_move_table(twist_move, POCKET_TWISTS, pocket_twist, pocket_set_twist, moves, NUM_POCKET_MOVES);
+
+    product = (coord_product){ 2, NUM_POCKET_MOVES, { POCKET_PERMS, POCKET_TWISTS }, { perm_move, twist_move } };
+    coord_space space;
+    coord_product_space(&product, &space);
+    if (table_dir == NULL) {
+        if (!pruning_table_generate(&distance, &space, 2, 0, NULL)) return 0;
+    }
+    else {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/pocket.prune", table_dir);
+        if (!pruning_table_load(&distance, &space, 2, path, pruning_table_key("pocket", space.size, 2), NULL)) return 0;
+    }
+
+    initialized = 1;
+    return 1;
+}
+
+// Applies up to two rotations bringing the DBL corner home untwisted, returns how many or -1 if none does
+static int bring_home(cube_state *state, uint8_t *rotations) {
+    uint8_t candidates[10];
+    candidates[0] = 0xFF;
+    for (int i = 0; i < 9; i++) candidates[1 + i] = MOVE(MOVE_X + i / 3, 1 + i % 3);
+
+    for (int a = 0; a < 10; a++) {
+        for (int b = 0; b < 10; b++) {
+            cube_state rotated = *state;
+            if (candidates[a] != 0xFF) cube_state_apply_move(&rotated, candidates[a]);
+            if (candidates[b] != 0xFF) cube_state_apply_move(&rotated, candidates[b]);
+            if ((rotated.cp[CORNER_DBL] != CORNER_DBL) || (rotated.co[CORNER_DBL] != 0)) continue;
+
+            int count = 0;
+            if (candidates[a] != 0xFF) rotations[count++] = candidates[a];
+            if (candidates[b] != 0xFF) rotations[count++] = candidates[b];
+            *state = rotated;
+            return count;
+        }
+    }
+    return -1;
+}
+
+// The corners must be a permutation with twists summing to a multiple of 3; edges and centres don't matter
+static int corners_valid(const cube_state *state) {
+    unsigned int seen = 0, total = 0;
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        if ((state->cp[i] >= NUM_CORNERS) || (state->co[i] > 2)) return 0;
+        seen |= 1u << state->cp[i];
+        total += state->co[i];
+    }
+    return (seen == (1u << NUM_CORNERS) - 1) && (total % 3 == 0);
+}
+
+static int index_home(cube_state *state, uint8_t *rotations, uint32_t *index) {
+    if (!corners_valid(state)) return -1;
+    uint8_t unused[2];
+    int count = bring_home(state, rotations ? rotations : unused);
+    if (count >= 0) *index = pocket_perm(state) * POCKET_TWISTS + pocket_twist(state);
+    return count;
+}
+
+uint32_t pocket_index(const cube_state *state) {
+    cube_state home = *state;
+    uint32_t index;
+    return (index_home(&home, NULL, &index) < 0) ? POCKET_STATES : index;
+}
+
+/*
+* Every neighbour is within one move of the goal of the current state, so with distances mod 3 the one stored as
+* distance - 1 is unambiguous. Stepping to any such neighbour until the goal gives a shortest path.
+*/
+static int walk(uint32_t index, uint8_t *moves) {
+    int length = 0;
+    unsigned int current = pruning_table_get(&distance, index);
+    while (index != 0) {
+        unsigned int wanted = (current + 2) % 3;
+        uint64_t next[NUM_POCKET_MOVES];
+        coord_product_neighbours(&product, index, next);
+        int m = 0;
+        while ((m < NUM_POCKET_MOVES) && (pruning_table_get(&distance, next[m]) != wanted)) m++;
+        if ((m == NUM_POCKET_MOVES) || (length == POCKET_MAX_LENGTH)) return -1;   // only with a corrupt table
+
+        if (moves) moves[length] = MOVE(MOVE_U + m / 3, 1 + m % 3);
+        length++;
+        index = (uint32_t)next[m];
+        current = wanted;
+    }
+    return length;
+}
+
+int pocket_distance(const cube_state *state) {
+    cube_state home = *state;
+    uint32_t index;
+    if (index_home(&home, NULL, &index) < 0) return -1;
+    return walk(index, NULL);
+}
+
+int pocket_solve(const cube_state *state, uint8_t *moves) {
+    cube_state home = *state;
+    uint32_t index;
+    int num_rotations = index_home(&home, moves, &index);
+    if (num_rotations < 0) return -1;
+    int length = walk(index, moves + num_rotations);
+    return (length < 0) ? -1 : num_rotations + length;
+}
@@ -0,0 +1,47 @@
+#ifndef POCKET_H
+#define POCKET_H
+
+#include <stdint.h>
+
+#include "cube_state.h"
+
+/*
+* 2x2x2 pocket cube, modelled by the corners of a cube_state. With the DBL corner held in place there are
+* 7! * 3^6 = 3,674,160 states, few enough to store every distance: 2 bits each (distance mod 3), under 1 MB. Solving
+* is then a walk down the table, each step taking a neighbour one closer, with no search.
+*
+* Distances are in face turns of U, R and F (the other faces only turn the cube about DBL), at most 11. The same
+* table is an exact oracle for the corners of a 3x3x3: solving its corners relative to each other takes at least
+* pocket_distance moves.
+*/
+#define POCKET_STATES 3674160
+#define POCKET_MAX_LENGTH 11
+#define POCKET_MAX_MOVES (POCKET_MAX_LENGTH + 2)
+
+/*
+* pocket_init: Loads or generates the distance table, which takes well under a second either way
+*
+* @param[in] table_dir: directory for the table file, NULL to generate it in memory
+*
+* @return 1 if successful, 0 if the table couldn't be loaded or allocated
+*/
+int pocket_init(const char *table_dir);
+
+// Index of a state's corners once DBL is brought home, POCKET_STATES if the corners aren't a valid arrangement
+uint32_t pocket_index(const cube_state *state);
+
+// Fewest face turns solving the corners, -1 if they aren't a valid arrangement
+int pocket_distance(const cube_state *state);
+
+/*
+* pocket_solve: Finds a shortest solution for the corners. If DBL isn't home it starts with up to two rotations
+* bringing it there, which don't count towards the length.
+*
+* @param[in] state: cube whose corners to solve
+* @param[out] moves: solution, room for POCKET_MAX_MOVES
+*
+* @return Number of moves, -1 if the corners aren't a valid arrangement
+*/
+int pocket_solve(const cube_state *state, uint8_t *moves);
+
+#endif // !POCKET_H
@@ -0,0 +1,382 @@
+#include "pruning_table.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
+
+#include "timer.h"
+#include "thread.h"
+
+// Entries per chunk claimed by a worker, a whole number of words for either entry size
+#define CHUNK_ENTRIES (1 << 16)
+#define MAX_THREADS 64
+
+#define FILE_MAGIC "RUBIXPT"
+#define FILE_HEADER_SIZE 4096
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t bits;
+    uint64_t size;
+    uint64_t key;
+    uint64_t checksum;
+} file_header;
+
+typedef struct {
+    _Atomic uint32_t *words;
+    const coord_space *space;
+    int bits;
+    int word_shift;             // log2 of entries per word
+    int backward;
+    unsigned int current;       // entry value of the layer being expanded
+    unsigned int next;          // entry value of the layer being found
+    atomic_uint_fast64_t next_chunk;
+    atomic_uint_fast64_t found;
+} layer_job;
+
+void coord_product_space(const coord_product *product, coord_space *space) {
+    space->size = 1;
+    for (int i = 0; i < product->num_coords; i++) space->size *= product->count[i];
+    space->goal = 0;
+    space->num_moves = product->num_moves;
+    space->neighbours = coord_product_neighbours;
+    space->context = product;
+}
+
+void coord_product_neighbours(const void *context, uint64_t index, uint64_t *next) {
+    const coord_product *product = context;
+    uint64_t scale[MAX_PRODUCT_COORDS];
+    unsigned int coord[MAX_PRODUCT_COORDS];
+
+    // 32-bit division is several times faster, and covers every product index up to 4G entries
+    uint64_t place = 1;
+    for (int i = product->num_coords - 1; i >= 0; i--) {
+        if (index <= UINT32_MAX) {
+            coord[i] = (uint32_t)index % product->count[i];
+            index = (uint32_t)index / product->count[i];
+        }
+        else {
+            coord[i] = (unsigned int)(index % product->count[i]);
+            index /= product->count[i];
+        }
+        scale[i] = place;
+        place *= product->count[i];
+    }
+
+    for (int m = 0; m < product->num_moves; m++) {
+        uint64_t result = 0;
+        for (int i = 0; i < product->num_coords; i++) result += product->move[i][(uint64_t)coord[i] * product->num_moves + m] * scale[i];
+        next[m] = result;
+    }
+}
+
+static unsigned int get_entry(layer_job *job, uint64_t index) {
+    uint32_t word = atomic_load_explicit(&job->words[index >> job->word_shift], memory_order_relaxed);
+    return (word >> ((index & ((1u << job->word_shift) - 1)) * job->bits)) & PRUNING_UNKNOWN(job->bits);
+}
+
+// Sets an entry if it is still unknown, returns 1 if this call set it
+static int claim_entry(layer_job *job, uint64_t index, unsigned int value) {
+    _Atomic uint32_t *word = &job->words[index >> job->word_shift];
+    int shift = (int)(index & ((1u << job->word_shift) - 1)) * job->bits;
+    uint32_t mask = PRUNING_UNKNOWN(job->bits) << shift;
+
+    uint32_t old = atomic_load_explicit(word, memory_order_relaxed);
+    do {
+        if ((old & mask) != mask) return 0;
+    } while (!atomic_compare_exchange_weak_explicit(word, &old, (old & ~mask) | (value << shift), memory_order_relaxed, memory_order_relaxed));
+    return 1;
+}
+
+// Whether any entry in a word is unknown (all its bits set)
+static int has_unknown(uint32_t word, int bits) {
+    uint32_t low = (bits == 4) ? 0x11111111u : 0x55555555u;
+    uint32_t all_set = word;
+    for (int b = 1; b < bits; b++) all_set &= word >> b;
+    return (all_set & low) != 0;
+}
+
+static void *layer_worker(void *arg) {
+    layer_job *job = arg;
+    const coord_space *space = job->space;
+    unsigned int unknown = PRUNING_UNKNOWN(job->bits);
+    uint64_t found = 0;
+
+    for (;;) {
+        uint64_t start = atomic_fetch_add(&job->next_chunk, CHUNK_ENTRIES);
+        if (start >= space->size) break;
+        uint64_t end = (start + CHUNK_ENTRIES < space->size) ? start + CHUNK_ENTRIES : space->size;
+
+        uint64_t per_word = 1u << job->word_shift;
+        for (uint64_t i = start; i < end; i++) {
+            // Whole words with nothing to do are common at both ends of the search, skip them in one go
+            if ((i & (per_word - 1)) == 0) {
+                uint32_t word = atomic_load_explicit(&job->words[i >> job->word_shift], memory_order_relaxed);
+                if ((job->backward && !has_unknown(word, job->bits)) || (!job->backward && (word == UINT32_MAX))) {
+                    i += per_word - 1;
+                    continue;
+                }
+            }
+
+            unsigned int value = get_entry(job, i);
+            if (value != (job->backward ? unknown : job->current)) continue;
+
+            uint64_t next[MAX_SPACE_MOVES];
+            space->neighbours(space->context, i, next);
+            if (job->backward) {
+                for (int m = 0; m < space->num_moves; m++) {
+                    if (get_entry(job, next[m]) == job->current) {
+                        found += claim_entry(job, i, job->next);
+                        break;
+                    }
+                }
+            }
+            else {
+                for (int m = 0; m < space->num_moves; m++) found += claim_entry(job, next[m], job->next);
+            }
+        }
+    }
+    atomic_fetch_add(&job->found, found);
+    return NULL;
+}
+
+static long peak_rss_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return (long)(counters.PeakWorkingSetSize >> 20);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss / 1024;
+#endif
+    return -1;
+}
+
+int pruning_table_generate(pruning_table *table, const coord_space *space, int bits, int threads, const char *name) {
+    int per_word = 32 / bits;
+    uint64_t num_words = (space->size + per_word - 1) / per_word;
+    table->words = malloc(num_words * sizeof(uint32_t));
+    if (table->words == NULL) {
+        printf("Failed to allocate %llu MB for pruning table\n", (unsigned long long)(num_words * sizeof(uint32_t) >> 20));
+        return 0;
+    }
+    memset(table->words, 0xFF, num_words * sizeof(uint32_t));
+    table->size = space->size;
+    table->bits = bits;
+    table->mapping = NULL;
+    table->mapping_size = 0;
+
+    if (threads <= 0) threads = thread_cpu_count();
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    layer_job job;
+    job.words = (_Atomic uint32_t *)table->words;
+    job.space = space;
+    job.bits = bits;
+    job.word_shift = (bits == 4) ? 3 : 4;
+    claim_entry(&job, space->goal, 0);
+
+    uint64_t start_ns = timer_now_ns();
+    uint64_t filled = 1;
+    for (unsigned int depth = 0; filled < space->size; depth++) {
+        if ((bits == 4) && (depth + 1 >= PRUNING_UNKNOWN(4))) {
+            printf("Pruning table %s: distances exceed %u, too deep for 4-bit entries\n", name ? name : "", PRUNING_UNKNOWN(4) - 1);
+            pruning_table_free(table);
+            return 0;
+        }
+
+        job.backward = filled > space->size / 2;
+        job.current = (bits == 4) ? depth : depth % 3;
+        job.next = (bits == 4) ? depth + 1 : (depth + 1) % 3;
+        atomic_init(&job.next_chunk, 0);
+        atomic_init(&job.found, 0);
+
+        thread_handle workers[MAX_THREADS];
+        int started = 0;
+        for (; started < threads; started++) {
+            if (!thread_create(&workers[started], layer_worker, &job)) break;
+        }
+        if (started == 0) layer_worker(&job);
+        for (int i = 0; i < started; i++) thread_join(workers[i]);
+
+        uint64_t found = atomic_load(&job.found);
+        filled += found;
+        if (name) {
+            double seconds = (double)(timer_now_ns() - start_ns) / NS_PER_SEC;
+            printf("%s: depth %2u %12llu states (%5.1f%%, %s) %7.2f s %8.2f M states/s, peak RSS %ld MB\n", name, depth + 1,
+                (unsigned long long)found, 100.0 * (double)filled / (double)space->size, job.backward ? "backward" : "forward ",
+                seconds, (double)filled / seconds / 1e6, peak_rss_mb());
+        }
+        if (found == 0) break;
+    }
+    return 1;
+}
+
+uint64_t pruning_table_key(const char *name, uint64_t size, int bits) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char *c = name; *c; c++) hash = (hash ^ (unsigned char)*c) * 0x100000001B3ull;
+    return (hash ^ size) * 0x100000001B3ull + (uint64_t)bits;
+}
+
+static uint64_t words_size(const pruning_table *table) {
+    uint64_t per_word = 32 / table->bits;
+    return (table->size + per_word - 1) / per_word * sizeof(uint32_t);
+}
+
+// Multiply-xorshift over 64-bit words, fast enough to verify hundreds of MB in well under a second
+static uint64_t checksum(const uint32_t *words, uint64_t bytes) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    uint64_t count = bytes / sizeof(uint32_t);
+    for (uint64_t i = 0; i < count; i++) {
+        hash = (hash ^ words[i]) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+// Keeps the temporary names of processes racing to write the same file apart
+static unsigned long process_id() {
+#ifdef _WIN32
+    return (unsigned long)GetCurrentProcessId();
+#else
+    return (unsigned long)getpid();
+#endif
+}
+
+int pruning_table_save(const pruning_table *table, const char *path, uint64_t key) {
+    file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = PRUNING_FILE_VERSION;
+    header.bits = (uint32_t)table->bits;
+    header.size = table->size;
+    header.key = key;
+    header.checksum = checksum(table->words, words_size(table));
+
+    size_t length = strlen(path);
+    char *temporary = malloc(length + 32);
+    if (temporary == NULL) return 0;
+    snprintf(temporary, length + 32, "%s.%lu.tmp", path, process_id());
+
+    FILE *file = fopen(temporary, "wb");
+    if (file == NULL) {
+        printf("Failed to create pruning table file %s\n", temporary);
+        free(temporary);
+        return 0;
+    }
+    static const char padding[FILE_HEADER_SIZE] = { 0 };
+    int ok = (fwrite(&header, sizeof(header), 1, file) == 1)
+        && (fwrite(padding, FILE_HEADER_SIZE - sizeof(header), 1, file) == 1)
+        && (fwrite(table->words, words_size(table), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && (rename(temporary, path) == 0);
+    if (!ok) {
+        printf("Failed to write pruning table file %s\n", path);
+        remove(temporary);
+    }
+    free(temporary);
+    return ok;
+}
+
+static int header_matches(const file_header *header, uint64_t key) {
+    return (memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0) && (header->version == PRUNING_FILE_VERSION)
+        && ((header->bits == 4) || (header->bits == 2)) && (header->key == key);
+}
+
+int pruning_table_open(pruning_table *table, const char *path, uint64_t key, int verify) {
+    table->words = NULL;
+    table->mapping = NULL;
+    table->mapping_size = 0;
+
+    file_header header;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 0;
+    int ok = (fread(&header, sizeof(header), 1, file) == 1) && header_matches(&header, key);
+    fclose(file);
+    if (!ok) return 0;
+
+    table->size = header.size;
+    table->bits = (int)header.bits;
+    uint64_t data_size = words_size(table);
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || ((uint64_t)info.st_size != FILE_HEADER_SIZE + data_size)) {
+        close(fd);
+        return 0;
+    }
+    void *mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return 0;
+#ifdef MADV_HUGEPAGE
+    madvise(mapping, (size_t)info.st_size, MADV_HUGEPAGE);
+#endif
+    table->mapping = mapping;
+    table->mapping_size = (size_t)info.st_size;
+    table->words = (uint32_t *)((char *)mapping + FILE_HEADER_SIZE);
+#else
+    // No shared mapping here, read a private copy
+    table->words = malloc(data_size);
+    file = fopen(path, "rb");
+    ok = (table->words != NULL) && (file != NULL) && (fseek(file, FILE_HEADER_SIZE, SEEK_SET) == 0)
+        && (fread(table->words, data_size, 1, file) == 1);
+    if (file) fclose(file);
+    table->mapping = NULL;
+    table->mapping_size = 0;
+    if (!ok) {
+        pruning_table_free(table);
+        return 0;
+    }
+#endif
+
+    if (verify && (checksum(table->words, data_size) != header.checksum)) {
+        printf("Pruning table file %s is corrupt\n", path);
+        pruning_table_free(table);
+        return 0;
+    }
+    return 1;
+}
+
+int pruning_table_load(pruning_table *table, const coord_space *space, int bits, const char *path, uint64_t key, const char *name) {
+    // Bad distances make a search miss solutions or never end, so a file found on disk is checked in full
+    if (pruning_table_open(table, path, key, 1) && (table->size == space->size) && (table->bits == bits)) return 1;
+    pruning_table_free(table);
+
+    if (!pruning_table_generate(table, space, bits, 0, name)) return 0;
+    if (!pruning_table_save(table, path, key)) return 1;
+
+    // Swap the private copy for the shared mapping, unchecked as it was only just written
+    pruning_table generated = *table;
+    if (!pruning_table_open(table, path, key, 0)) {
+        *table = generated;
+        return 1;
+    }
+    pruning_table_free(&generated);
+    return 1;
+}
+
+void pruning_table_free(pruning_table *table) {
+#ifndef _WIN32
+    if (table->mapping) {
+        munmap(table->mapping, table->mapping_size);
+        table->mapping = NULL;
+        table->words = NULL;
+        return;
+    }
+#endif
+    free(table->words);
+    table->words = NULL;
+}
@@ -0,0 +1,130 @@
+#ifndef PRUNING_TABLE_H
+#define PRUNING_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Distance-to-goal table over a coordinate space, packed into 32-bit words. 4-bit entries hold the distance itself;
+* 2-bit entries hold it mod 3, which is enough for a search that knows the exact distance of its current node and
+* moves one step at a time (only one of distance - 1, distance, distance + 1 can match).
+*/
+typedef struct {
+    uint32_t *words;
+    uint64_t size;      // entries
+    int bits;           // 4 or 2
+    void *mapping;      // file mapping the words live in, NULL if they were allocated
+    size_t mapping_size;
+} pruning_table;
+
+#define PRUNING_UNKNOWN(bits) ((1u << (bits)) - 1)
+
+#define MAX_SPACE_MOVES 32
+
+// A space of coordinates numbered 0..size-1, with a function giving the coordinates one move away from one
+typedef struct {
+    uint64_t size;
+    uint64_t goal;
+    int num_moves;      // at most MAX_SPACE_MOVES
+    void (*neighbours)(const void *context, uint64_t index, uint64_t *next);
+    const void *context;
+} coord_space;
+
+/*
+* Product of coordinates that each have a move table, indexed [coordinate * num_moves + move]. The product index is
+* ((c0 * count1 + c1) * count2 + c2)..., its goal is all coordinates 0.
+*/
+#define MAX_PRODUCT_COORDS 4
+
+typedef struct {
+    int num_coords;
+    int num_moves;
+    unsigned int count[MAX_PRODUCT_COORDS];
+    const uint16_t *move[MAX_PRODUCT_COORDS];
+} coord_product;
+
+void coord_product_space(const coord_product *product, coord_space *space);
+
+void coord_product_neighbours(const void *context, uint64_t index, uint64_t *next);
+
+/*
+* pruning_table_generate: Fills a table with the distance of every coordinate from the goal. Breadth-first, one
+* layer at a time: each layer is split into chunks that worker threads claim, and entries are written with
+* compare-and-swap so neighbouring entries sharing a word can be set concurrently. Early layers expand the
+* entries found last layer; once more than half the table is known, unknown entries instead look for a neighbour
+* in the last layer. The space's moves must be closed under inverses.
+*
+* @param[out] table: table to fill, allocated here
+* @param[in] space: coordinate space to search
+* @param[in] bits: 4, or 2 for distance mod 3
+* @param[in] threads: worker threads, 0 for one per core
+* @param[in] name: printed with per-layer progress, states/s and peak memory, NULL for none
+*
+* @return 1 if successful, 0 if out of memory or a distance doesn't fit in 4 bits
+*/
+int pruning_table_generate(pruning_table *table, const coord_space *space, int bits, int threads, const char *name);
+
+/*
+* Table files: a 4 KB header followed by the packed words, so the words start page aligned and can be mapped in
+* place. The header holds a magic string, the format version, the entry size and count, a key identifying the
+* coordinate space the table was built for, and a checksum of the words.
+*/
+#define PRUNING_FILE_VERSION 1
+
+// Key for a table file, from a name for the coordinate space that should change whenever its encoding does
+uint64_t pruning_table_key(const char *name, uint64_t size, int bits);
+
+/*
+* pruning_table_save: Writes a table file. It is written under a temporary name and renamed into place, so other
+* processes never map a partly written file.
+*
+* @param[in] table: table to write
+* @param[in] path: file to write
+* @param[in] key: identifies the coordinate space, checked when the file is opened
+*
+* @return 1 if successful, 0 otherwise
+*/
+int pruning_table_save(const pruning_table *table, const char *path, uint64_t key);
+
+/*
+* pruning_table_open: Maps a table file read-only. The pages are shared with every other process mapping the same
+* file and only read from disk as they are touched, so opening is close to instant. Where supported the mapping is
+* advised to use huge pages, cutting TLB misses on the random lookups of a search.
+*
+* @param[out] table: mapped table, release with pruning_table_free
+* @param[in] path: file to map
+* @param[in] key: expected coordinate space key
+* @param[in] verify: 1 to check the checksum, which reads the whole file
+*
+* @return 1 if successful, 0 if the file is missing, from another version or space, or corrupt
+*/
+int pruning_table_open(pruning_table *table, const char *path, uint64_t key, int verify);
+
+/*
+* pruning_table_load: Opens a table file, or generates the table, saves it and opens that when the file is missing,
+* stale or corrupt. An existing file's checksum is verified, which reads it once. Processes racing to create the same
+* file each generate it, and the last rename wins.
+*
+* @return 1 if successful, 0 otherwise
+*/
+int pruning_table_load(pruning_table *table, const coord_space *space, int bits, const char *path, uint64_t key, const char *name);
+
+// Frees or unmaps a table
+void pruning_table_free(pruning_table *table);
+
+static inline unsigned int pruning_table_get(const pruning_table *table, uint64_t index) {
+    if (table->bits == 4) return (table->words[index >> 3] >> ((index & 7) * 4)) & 0xF;
+    return (table->words[index >> 4] >> ((index & 15) * 2)) & 0x3;
+}
+
+// Starts loading the word holding an entry, for a lookup a little later
+static inline void pruning_table_prefetch(const pruning_table *table, uint64_t index) {
+#if defined(__GNUC__)
+    __builtin_prefetch(&table->words[index >> (table->bits == 4 ? 3 : 4)]);
+#else
+    (void)table;
+    (void)index;
+#endif
+}
+
+#endif // !PRUNING_TABLE_H
@@ -41,6 +41,26 @@ quaternion quaternion_mul(const quaternion a, const quaternion b) {
 	return q;
 }
 
+quaternion quaternion_nlerp(const quaternion a, const quaternion b, const float t) {
+	// q and -q are the same rotation, flip b onto a's hemisphere so we take the short way round
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.s * b.s;
+	float tb = (dot < 0.f) ? -t : t;
+	float ta = 1.f - t;
+
+	quaternion q;
+	q.x = ta * a.x + tb * b.x;
+	q.y = ta * a.y + tb * b.y;
+	q.z = ta * a.z + tb * b.z;
+	q.s = ta * a.s + tb * b.s;
+
+	float norm = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.s * q.s);
+	q.x /= norm;
+	q.y /= norm;
+	q.z /= norm;
+	q.s /= norm;
+	return q;
+}
+
 void quaternion_mat(const quaternion q, mat4 mat) {
 	float x2  = q.x + q.x;
 	float y2  = q.y + q.y;
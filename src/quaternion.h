@@ -25,6 +25,18 @@ quaternion quaternion_create(const vec3 axis, const float rads);
 // Multiplies (combines) two quaternions
 quaternion quaternion_mul(const quaternion a, const quaternion b);
 
+/*
+* quaternion_nlerp: Interpolates between two rotations along the shortest path. Cheaper than slerp, and close
+* enough for the small steps between two simulation ticks
+*
+* @param[in] a: rotation at t = 0
+* @param[in] b: rotation at t = 1
+* @param[in] t: interpolation factor in [0, 1]
+*
+* @return normalized interpolated rotation
+*/
+quaternion quaternion_nlerp(const quaternion a, const quaternion b, const float t);
+
 /*
 * quaternion_mat: Generate a rotation matrix from a quaternion
 * 
@@ -1 +1,44 @@
-#include "ray.h"
\ No newline at end of file
+#include "ray.h"
+
+#define EPSILON 0.00001f
+
+int ray_triangle_intersect(const ray r, const vec3 v0, const vec3 v1, const vec3 v2, float *t) {
+	vec3 v0v1, v0v2, pvec, tvec, qvec;
+	vec3_sub(v1, v0, v0v1);
+	vec3_sub(v2, v0, v0v2);
+	vec3_cross(r.direction, v0v2, pvec);
+
+	// Back facing or parallel to the triangle
+	float det = vec3_dot(v0v1, pvec);
+	if (det < EPSILON) return 0;
+	float inv_det = 1.0f / det;
+
+	vec3_sub(r.origin, v0, tvec);
+	float u = vec3_dot(tvec, pvec) * inv_det;
+	if ((u < 0.0f) || (u > 1.0f)) return 0;
+
+	vec3_cross(tvec, v0v1, qvec);
+	float v = vec3_dot(r.direction, qvec) * inv_det;
+	if ((v < 0.0f) || (u + v > 1.0f)) return 0;
+
+	float distance = vec3_dot(v0v2, qvec) * inv_det;
+	if (distance < EPSILON) return 0;
+
+	*t = distance;
+	return 1;
+}
+
+int ray_pick(const ray r, const float *vertices, const unsigned short *indices, int index_count, float *t) {
+	int closest = -1;
+	float closest_t = 0;
+	for (int i = 0; i + 2 < index_count; i += 3) {
+		float hit_t;
+		if (!ray_triangle_intersect(r, vertices + 3 * indices[i], vertices + 3 * indices[i + 1], vertices + 3 * indices[i + 2], &hit_t)) continue;
+		if ((closest < 0) || (hit_t < closest_t)) {
+			closest = i / 3;
+			closest_t = hit_t;
+		}
+	}
+	if (closest >= 0) *t = closest_t;
+	return closest;
+}
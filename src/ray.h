@@ -8,4 +8,29 @@ typedef struct {
 	vec3 direction;
 } ray;
 
+/*
+* ray_triangle_intersect: Moller-Trumbore ray/triangle intersection. Only front faces (counter-clockwise winding
+* as seen by the ray) are hit, matching the renderer's back face culling.
+*
+* @param[in] r: ray to test
+* @param[in] v0, v1, v2: triangle corners
+* @param[out] t: distance along the ray direction to the hit point, only written on a hit
+*
+* @return 1 if the ray hits the triangle in front of its origin, 0 otherwise
+*/
+int ray_triangle_intersect(const ray r, const vec3 v0, const vec3 v1, const vec3 v2, float *t);
+
+/*
+* ray_pick: Finds the closest triangle of an indexed triangle mesh hit by a ray
+*
+* @param[in] r: ray, in the same space as the vertices
+* @param[in] vertices: xyz vertex positions
+* @param[in] indices: three vertex indices per triangle
+* @param[in] index_count: number of indices
+* @param[out] t: distance to the closest hit, only written on a hit
+*
+* @return Index of the closest triangle hit, -1 if none
+*/
+int ray_pick(const ray r, const float *vertices, const unsigned short *indices, int index_count, float *t);
+
 #endif // !RAY_H
@@ -0,0 +1,120 @@
+#include "render_thread.h"
+
+#include <stdatomic.h>
+
+#include "window.h"
+#include "renderer.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "capture.h"
+#include "timer.h"
+#include "thread.h"
+
+#define FPS 144
+
+static thread_handle thread;
+static atomic_int running;
+static int refresh_rate; // of the display, read on the main thread as GLFW requires
+
+// Start-up handshake, init_status is -1 until the render thread has initialized
+static thread_mutex init_mutex = THREAD_MUTEX_INITIALIZER;
+static thread_cond init_cond = THREAD_COND_INITIALIZER;
+static int init_status;
+
+static void *render_loop(void *arg);
+static void signal_init(int status);
+static float interpolation_alpha(const frame_snapshot *snapshot);
+
+int render_thread_start() {
+    init_status = -1;
+    atomic_store(&running, 1);
+    refresh_rate = window_refresh_rate();
+
+    window_release_context();
+    if (!thread_create(&thread, render_loop, NULL)) {
+        window_acquire_context();
+        return 0;
+    }
+
+    thread_mutex_lock(&init_mutex);
+    while (init_status < 0) thread_cond_wait(&init_cond, &init_mutex);
+    int status = init_status;
+    thread_mutex_unlock(&init_mutex);
+
+    if (!status) {
+        thread_join(thread);
+        window_acquire_context();
+    }
+    return status;
+}
+
+void render_thread_stop() {
+    atomic_store(&running, 0);
+    thread_join(thread);
+}
+
+static void *render_loop(void *arg) {
+    window_acquire_context();
+    // A recording runs at the display's rate, each presented frame one video frame
+    int display_fps = (refresh_rate > 0) ? refresh_rate : FPS;
+    if (!renderer_init() || !telemetry_init() || !capture_start(window_width(), window_height(), display_fps)) {
+        window_release_context();
+        signal_init(0);
+        return NULL;
+    }
+    signal_init(1);
+
+    /*
+    * While recording, every frame waits for a vblank so frames are presented at exactly the display's rate. Otherwise
+    * the scheduler paces frames, and a driver default swap interval would wait on vblank on top of it.
+    */
+    int recording = capture_active();
+    window_set_vsync(recording);
+
+    scheduler frame_scheduler;
+    scheduler_init(&frame_scheduler, 0, recording ? 0 : FPS);
+
+    while (atomic_load(&running)) {
+        scheduler_begin_frame(&frame_scheduler);
+
+        const frame_snapshot *snapshot = snapshot_read(NULL);
+        if (snapshot) {
+            telemetry_begin(PHASE_DRAW);
+            telemetry_gpu_begin();
+            draw(snapshot, interpolation_alpha(snapshot));
+            telemetry_gpu_end();
+            telemetry_end(PHASE_DRAW);
+
+            capture_frame(timer_now_ns());
+
+            telemetry_begin(PHASE_SWAP_BUFFERS);
+            swap_buffers();
+            telemetry_end(PHASE_SWAP_BUFFERS);
+        }
+
+        scheduler_end_frame(&frame_scheduler);
+        telemetry_end_frame();
+    }
+
+    capture_stop();
+    scheduler_report(&frame_scheduler);
+    telemetry_report();
+    telemetry_cleanup();
+    window_release_context();
+    return NULL;
+}
+
+static void signal_init(int status) {
+    thread_mutex_lock(&init_mutex);
+    init_status = status;
+    thread_cond_signal(&init_cond);
+    thread_mutex_unlock(&init_mutex);
+}
+
+// Snapshots are one simulation step apart, interpolate by how far into the next step we are
+static float interpolation_alpha(const frame_snapshot *snapshot) {
+    if (snapshot->step_ns == 0) return 1.f;
+    double alpha = (double)(timer_now_ns() - snapshot->time_ns) / (double)snapshot->step_ns;
+    return (alpha < 1.0) ? (float)alpha : 1.f;
+}
@@ -0,0 +1,15 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+/*
+* render_thread_start: Hands the window's GL context to a new render thread, which initializes the renderer and
+* then draws the latest published snapshot every frame. Returns once initialization finished.
+*
+* @return 1 if the render thread is running, 0 if it failed to start (the context is back on the calling thread)
+*/
+int render_thread_start();
+
+// Stops and joins the render thread, printing its frame statistics
+void render_thread_stop();
+
+#endif // !RENDER_THREAD_H
@@ -1,21 +1,48 @@
 #include "renderer.h"
 
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <stb_image.h>
 
 #include "shader.h"
-#include "window.h"
-#include "camera.h"
 #include "cube.h"
+#include "stream_buffer.h"
 
-static Shader shader;
+// Uniform buffer binding points of the Cubies and Frame blocks in basic.vert and static.vert
+#define CUBIES_BINDING 0
+#define FRAME_BINDING 1
+
+// Unchanged cubies a transform upload copies rather than splitting into two calls
+#define MAX_CLEAN_GAP 2
+
+#define VERTEX_PER_FACE 4
+
+// Mirrors the Frame block in the vertex shaders, rewritten every frame
+typedef struct {
+    mat4 mvp;
+} frame_block;
+
+// static_shader skips the per vertex cubie transform, and is drawn with while no layer is turning
+static Shader animating_shader, static_shader;
 static unsigned int VAO;
+static unsigned int colour_BO, cubies_UBO;
+static stream_buffer frame_stream;
+static int index_count;
+
+// Render thread's copy of what the GPU buffers currently hold, so only changes get uploaded
+static unsigned char vertex_colours[NUM_CUBES * FACES_PER_CUBE * VERTEX_PER_FACE];
+static unsigned char uploaded_colours[NUM_CUBES * FACES_PER_CUBE];
+static mat4 uploaded_transforms[NUM_CUBES];
+static int transforms_identity = 1;
+static int viewport_width, viewport_height;
 
 static void buffers_init();
 static void texture_init();
+static void upload_cubie_state(const frame_snapshot *snapshot);
 
 int renderer_init() {
     // Loading OpenGL function pointers
@@ -28,59 +55,86 @@ int renderer_init() {
     glCullFace(GL_BACK);
 
     // Shaders
-    shader = shader_create("../shaders/basic.vert", "../shaders/basic.frag");
-
-    // OpenGL generated objects (vao, vbo, ebo, texture)
+    animating_shader = shader_create("../shaders/basic.vert", "../shaders/basic.frag");
+    static_shader = shader_create("../shaders/static.vert", "../shaders/basic.frag");
+    if ((animating_shader == BAD_SHADER) || (static_shader == BAD_SHADER)) return 0;
+    set_uniform_block_binding(animating_shader, "Cubies", CUBIES_BINDING);
+    set_uniform_block_binding(animating_shader, "Frame", FRAME_BINDING);
+    set_uniform_block_binding(static_shader, "Frame", FRAME_BINDING);
+
+    // OpenGL generated objects (vao, vbo, ebo, ubo, texture)
     buffers_init();
     texture_init();
 
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (!stream_buffer_init(&frame_stream, GL_UNIFORM_BUFFER, sizeof(frame_block), (size_t)alignment)) return 0;
+
     return 1;
 }
 
-void draw() {
+void draw(const frame_snapshot *snapshot, float alpha) {
+    // Viewport follows the window, which is resized on the main thread
+    if ((snapshot->viewport_width != viewport_width) || (snapshot->viewport_height != viewport_height)) {
+        viewport_width = snapshot->viewport_width;
+        viewport_height = snapshot->viewport_height;
+        glViewport(0, 0, viewport_width, viewport_height);
+    }
+
     // Clear screen
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Activate shader
-    shader_use(shader);
+    // Cubie transforms and sticker colours, only touched when the simulation changed them
+    upload_cubie_state(snapshot);
 
-    // Camera & projection
-    mat4 view_mat, proj_mat;
-    look_at(*cube_pos());
-    get_view_matrix(view_mat);
-    get_perspective_matrix(60.f, (float)window_width() / (float)window_height(), 0.1f, 100.f, proj_mat);
-    set_uniform_mat4f(shader, "view", view_mat);
-    set_uniform_mat4f(shader, "projection", proj_mat);
+    // Activate shader, the cubie transforms are only worth applying per vertex while a layer is turning
+    shader_use(transforms_identity ? static_shader : animating_shader);
+
+    // Camera & projection, once per frame
+    mat4 view_projection;
+    mat_mul(snapshot->projection, snapshot->view, view_projection);
 
     // Drawing
     glBindVertexArray(VAO);
 
     mat4 model_translate, model_rotate, model;
-    translation_mat(*cube_pos(), model_translate);
-    quaternion_mat(*cube_orientation(), model_rotate);
+    translation_mat(snapshot->cube_pos, model_translate);
+    quaternion_mat(quaternion_nlerp(snapshot->orientation[0], snapshot->orientation[1], alpha), model_rotate);
     mat_mul(model_translate, model_rotate, model);
-    set_uniform_mat4f(shader, "model", model);
 
-    int element_buffer_len; // TODO: Should I be querying every single time?
-    glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &element_buffer_len);
-    glDrawElements(GL_TRIANGLES, element_buffer_len, GL_UNSIGNED_INT, 0);
+    // Model view projection, written to a region of the stream the GPU isn't reading so the upload never stalls
+    size_t frame_offset;
+    frame_block *frame = stream_buffer_map(&frame_stream, sizeof(frame_block), &frame_offset);
+    if (frame) {
+        mat_mul(view_projection, model, frame->mvp);
+        stream_buffer_unmap(&frame_stream);
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BINDING, frame_stream.buffer, (GLintptr)frame_offset, sizeof(frame_block));
+    }
+
+    glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_SHORT, 0);
+    stream_buffer_end_frame(&frame_stream);
 }
 
 void buffers_init() {
-    // Initializing and retrieving actual cube data
-    cube_init_data();
-    int vertices_size, indices_size, texture_info_size;
-    float *vertices = cube_vertex_info(&vertices_size);
-    unsigned int *indices = cube_index_info(&indices_size);
-    float *texture_info = cube_texture_info(&texture_info_size);
+    // Retrieving actual cube data, generated by cube_init_data
+    int vertices_size, indices_size;
+    cube_vertex *vertices = cube_vertex_info(&vertices_size);
+    unsigned short *indices = cube_index_info(&indices_size);
+    index_count = indices_size / (int)sizeof(unsigned short);
+
+    cube_sticker_colours(uploaded_colours);
+    for (int face = 0; face < NUM_CUBES * FACES_PER_CUBE; face++) {
+        memset(vertex_colours + face * VERTEX_PER_FACE, uploaded_colours[face], VERTEX_PER_FACE);
+    }
 
     // Generating OpenGL buffers
-    unsigned int element_BO, vertex_BO, texture_info_BO;
+    unsigned int element_BO, vertex_BO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &vertex_BO);
-    glGenBuffers(1, &texture_info_BO);
+    glGenBuffers(1, &colour_BO);
     glGenBuffers(1, &element_BO);
+    glGenBuffers(1, &cubies_UBO);
     glBindVertexArray(VAO);
 
     // Binding data
@@ -88,21 +142,75 @@ void buffers_init() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_BO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_size, indices, GL_STATIC_DRAW);
 
-    // 2. Vertices
+    // 2. Vertices, packed positions and texture coords that never change
     glBindBuffer(GL_ARRAY_BUFFER, vertex_BO);
-    glBufferData(GL_ARRAY_BUFFER, vertices_size, vertices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    glBufferData(GL_ARRAY_BUFFER, vertices_size, vertices, GL_STATIC_DRAW);
+    // position, scaled integers the shader divides back down
+    glVertexAttribPointer(0, 3, GL_BYTE, GL_FALSE, sizeof(cube_vertex), (void *)offsetof(cube_vertex, position));
     glEnableVertexAttribArray(0);
-
-    // 3. Texture info
-    glBindBuffer(GL_ARRAY_BUFFER, texture_info_BO);
-    glBufferData(GL_ARRAY_BUFFER, texture_info_size, texture_info, GL_STATIC_DRAW);
     // texture coord
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(cube_vertex), (void *)offsetof(cube_vertex, tex_coord));
     glEnableVertexAttribArray(1);
-    // colour
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)(2 * sizeof(float)));
+
+    // 3. Colours, a byte per vertex that changes as the cube is turned, read by the shader as an integer
+    glBindBuffer(GL_ARRAY_BUFFER, colour_BO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_colours), vertex_colours, GL_DYNAMIC_DRAW);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_BYTE, sizeof(unsigned char), (void *)0);
     glEnableVertexAttribArray(2);
+
+    // 4. Cubie transforms
+    for (int i = 0; i < NUM_CUBES; i++) ident(uploaded_transforms[i]);
+    glBindBuffer(GL_UNIFORM_BUFFER, cubies_UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(uploaded_transforms), uploaded_transforms, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CUBIES_BINDING, cubies_UBO);
+}
+
+/*
+* A face turn moves 9 cubies. In cube_vertex_info order the U, D and E layers are one run, F, B and S three runs of
+* three, and R, L and M every third cubie. Each run of changed transforms goes up in one glBufferSubData, bridging
+* gaps of up to MAX_CLEAN_GAP unchanged cubies where one larger copy is cheaper than another call.
+*/
+static void upload_cubie_state(const frame_snapshot *snapshot) {
+    int bound = 0, changed = 0;
+    for (int first = 0; first < NUM_CUBES; first++) {
+        if (memcmp(uploaded_transforms[first], snapshot->cubie_transform[first], sizeof(mat4)) == 0) continue;
+
+        int end = first + 1, clean = 0;
+        for (int i = end; (i < NUM_CUBES) && (clean <= MAX_CLEAN_GAP); i++) {
+            if (memcmp(uploaded_transforms[i], snapshot->cubie_transform[i], sizeof(mat4)) == 0) clean++;
+            else {
+                end = i + 1;
+                clean = 0;
+            }
+        }
+
+        memcpy(uploaded_transforms[first], snapshot->cubie_transform[first], (size_t)(end - first) * sizeof(mat4));
+        if (!bound) {
+            glBindBuffer(GL_UNIFORM_BUFFER, cubies_UBO);
+            bound = 1;
+        }
+        glBufferSubData(GL_UNIFORM_BUFFER, first * (GLintptr)sizeof(mat4), (end - first) * (GLsizeiptr)sizeof(mat4), uploaded_transforms[first]);
+        first = end - 1;
+        changed = 1;
+    }
+
+    if (changed) {
+        mat4 identity;
+        ident(identity);
+        transforms_identity = 1;
+        for (int i = 0; (i < NUM_CUBES) && transforms_identity; i++) {
+            transforms_identity = (memcmp(uploaded_transforms[i], identity, sizeof(mat4)) == 0);
+        }
+    }
+
+    if (memcmp(uploaded_colours, snapshot->sticker_colour, sizeof(uploaded_colours)) != 0) {
+        memcpy(uploaded_colours, snapshot->sticker_colour, sizeof(uploaded_colours));
+        for (int face = 0; face < NUM_CUBES * FACES_PER_CUBE; face++) {
+            memset(vertex_colours + face * VERTEX_PER_FACE, uploaded_colours[face], VERTEX_PER_FACE);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, colour_BO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertex_colours), vertex_colours);
+    }
 }
 
 static void texture_init() {
@@ -123,4 +231,4 @@ static void texture_init() {
         printf("Failed to load texture\n");
     }
     stbi_image_free(data);
-}
\ No newline at end of file
+}
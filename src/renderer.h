@@ -1,7 +1,17 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "snapshot.h"
+
+// Needs the GL context current on the calling thread, and cube_init_data to have run
 int renderer_init();
-void draw();
 
-#endif
\ No newline at end of file
+/*
+* draw: Renders one frame from a simulation snapshot
+*
+* @param[in] snapshot: state to render
+* @param[in] alpha: how far the frame lies between the snapshot's previous and current step, used to interpolate motion
+*/
+void draw(const frame_snapshot *snapshot, float alpha);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xoshiro256** generator, small and fast enough to draw millions of cube states per second. Not thread safe, use
+// one per thread.
+typedef struct {
+    uint64_t s[4];
+} rng;
+
+// Seeds the generator by expanding seed through splitmix64, so nearby seeds give unrelated streams
+void rng_seed(rng *r, uint64_t seed);
+
+uint64_t rng_next(rng *r);
+
+// Uniform in [0, bound), without modulo bias. bound must be non-zero.
+uint64_t rng_below(rng *r, uint64_t bound);
+
+#endif // !RNG_H
@@ -0,0 +1,66 @@
+#include "scheduler.h"
+
+#include <stdio.h>
+
+#include "timer.h"
+
+// Sleep granularity is around 1ms on most desktop kernels; the last stretch before a deadline is spun instead
+#define SPIN_NS (2 * NS_PER_MS)
+
+// Upper bound of simulation steps per frame, so a long stall (debugger, window drag) can't snowball
+#define MAX_UPDATES_PER_FRAME 8
+
+void scheduler_init(scheduler *s, double updates_per_second, double frames_per_second) {
+    uint64_t now = timer_now_ns();
+    s->update_ns = (updates_per_second > 0) ? (uint64_t)(NS_PER_SEC / updates_per_second) : 0;
+    s->frame_ns = (frames_per_second > 0) ? (uint64_t)(NS_PER_SEC / frames_per_second) : 0;
+    s->spin_ns = SPIN_NS;
+    s->previous_ns = now;
+    s->accumulator_ns = 0;
+    s->deadline_ns = now + s->frame_ns;
+    s->frames = 0;
+    s->missed_deadlines = 0;
+    s->dropped_updates = 0;
+}
+
+int scheduler_begin_frame(scheduler *s) {
+    uint64_t now = timer_now_ns();
+    s->accumulator_ns += now - s->previous_ns;
+    s->previous_ns = now;
+    if (s->update_ns == 0) return 0;
+
+    uint64_t updates = s->accumulator_ns / s->update_ns;
+    s->accumulator_ns -= updates * s->update_ns;
+    if (updates > MAX_UPDATES_PER_FRAME) {
+        s->dropped_updates += updates - MAX_UPDATES_PER_FRAME;
+        updates = MAX_UPDATES_PER_FRAME;
+    }
+    return (int)updates;
+}
+
+float scheduler_alpha(const scheduler *s) {
+    if (s->update_ns == 0) return 0.f;
+    return (float)((double)s->accumulator_ns / (double)s->update_ns);
+}
+
+void scheduler_end_frame(scheduler *s) {
+    s->frames++;
+    if (s->frame_ns == 0) return;
+
+    uint64_t now = timer_now_ns();
+    if (now > s->deadline_ns) {
+        s->missed_deadlines++;
+        s->deadline_ns = now + s->frame_ns;
+        return;
+    }
+
+    timer_wait_until_ns(s->deadline_ns, s->spin_ns);
+    s->deadline_ns += s->frame_ns;
+}
+
+void scheduler_report(const scheduler *s) {
+    double missed_pct = s->frames ? 100.0 * (double)s->missed_deadlines / (double)s->frames : 0.0;
+    printf("Frames: %llu, missed deadlines: %llu (%.2f%%), dropped updates: %llu\n",
+        (unsigned long long)s->frames, (unsigned long long)s->missed_deadlines, missed_pct,
+        (unsigned long long)s->dropped_updates);
+}
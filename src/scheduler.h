@@ -0,0 +1,66 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/*
+* Fixed-timestep frame scheduler. Simulation advances in constant update_ns steps regardless of frame rate,
+* rendering happens once per frame and interpolates between the last two simulation steps.
+*
+* Usage per frame:
+*   int updates = scheduler_begin_frame(&s);
+*   while (updates-- > 0) update();
+*   render(scheduler_alpha(&s));
+*   scheduler_end_frame(&s);
+*/
+typedef struct {
+    uint64_t update_ns;         // length of one simulation step
+    uint64_t frame_ns;          // target frame period, 0 when uncapped
+    uint64_t spin_ns;           // busy-wait window before a frame deadline
+    uint64_t previous_ns;       // start of the previous frame
+    uint64_t accumulator_ns;    // wall time not yet consumed by simulation steps
+    uint64_t deadline_ns;       // when the next frame is due to start
+    uint64_t frames;
+    uint64_t missed_deadlines;  // frames that finished after their deadline
+    uint64_t dropped_updates;   // simulation steps skipped to catch up after a stall
+} scheduler;
+
+/*
+* scheduler_init: Sets up a scheduler starting at the current time
+*
+* @param[out] s: scheduler to initialize
+* @param[in] updates_per_second: fixed simulation rate, 0 for a frame-pacing-only scheduler with no updates
+* @param[in] frames_per_second: frame cap, 0 to render as fast as possible (e.g. when vsync paces frames)
+*/
+void scheduler_init(scheduler *s, double updates_per_second, double frames_per_second);
+
+/*
+* scheduler_begin_frame: Marks the start of a frame
+*
+* @param[in] s: scheduler
+*
+* @return Number of fixed simulation steps to run before rendering this frame
+*/
+int scheduler_begin_frame(scheduler *s);
+
+/*
+* scheduler_alpha: How far between the last two simulation steps the current frame lies
+*
+* @param[in] s: scheduler
+*
+* @return Interpolation factor in [0, 1)
+*/
+float scheduler_alpha(const scheduler *s);
+
+/*
+* scheduler_end_frame: Waits for the next frame deadline. A frame that already overran its deadline is counted
+* as missed and the schedule restarts from now instead of trying to catch up.
+*
+* @param[in] s: scheduler
+*/
+void scheduler_end_frame(scheduler *s);
+
+// Prints frame and deadline statistics
+void scheduler_report(const scheduler *s);
+
+#endif // !SCHEDULER_H
@@ -0,0 +1,31 @@
+#include "scramble.h"
+
+#include "coordinates.h"
+#include "two_phase.h"
+
+void scramble_random_state(rng *r, cube_state *state) {
+    cube_state_solved(state);
+    coord_set_corner_perm(state, (unsigned int)rng_below(r, NUM_CORNER_PERMS));
+    coord_set_edge_perm(state, (unsigned int)rng_below(r, NUM_EDGE_PERMS));
+    coord_set_twist(state, (unsigned int)rng_below(r, NUM_TWISTS));
+    coord_set_flip(state, (unsigned int)rng_below(r, NUM_FLIPS));
+
+    if (permutation_parity(state->cp, NUM_CORNERS) != permutation_parity(state->ep, NUM_EDGES)) {
+        uint8_t corner = state->cp[0];
+        state->cp[0] = state->cp[1];
+        state->cp[1] = corner;
+    }
+}
+
+int scramble_moves(rng *r, uint8_t *moves, int max_length) {
+    cube_state state;
+    scramble_random_state(r, &state);
+
+    uint8_t solution[TWO_PHASE_MAX_MOVES];
+    int count = two_phase_solve(&state, max_length, 0, solution);
+    if (count < 0) return -1;
+    for (int i = 0; i < count; i++) moves[i] = MOVE_INVERSE(solution[count - 1 - i]);
+
+    // Reversing swaps the order of commuting opposite face turns, put them back
+    return (int)moves_canonicalise(moves, (size_t)count);
+}
@@ -0,0 +1,30 @@
+#ifndef SCRAMBLE_H
+#define SCRAMBLE_H
+
+#include "cube_state.h"
+#include "rng.h"
+
+/*
+* scramble_random_state: Draws a cube state uniformly from all reachable ones, with centres at home. Each
+* permutation and orientation is unranked from a uniform index; when the corner and edge permutations have
+* different parity the first two corners are swapped, which pairs odd and even permutations one to one and so
+* keeps the draw uniform.
+*
+* @param[in,out] r: generator to draw from
+* @param[out] state: random state
+*/
+void scramble_random_state(rng *r, cube_state *state);
+
+/*
+* scramble_moves: Draws a uniform random state and writes a face turn sequence that produces it from the solved cube,
+* the inverse of its two-phase solution. two_phase_init must have been called.
+*
+* @param[in,out] r: generator to draw from
+* @param[out] moves: scramble, room for TWO_PHASE_MAX_MOVES
+* @param[in] max_length: longest acceptable scramble, 22 keeps this to a few milliseconds
+*
+* @return Number of moves, -1 if no sequence that short was found
+*/
+int scramble_moves(rng *r, uint8_t *moves, int max_length);
+
+#endif // !SCRAMBLE_H
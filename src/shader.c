@@ -54,10 +54,14 @@ void set_uniform_float(Shader shader, const char *name, float value) {
 	glUniform1f(glGetUniformLocation(shader, name), value);
 }
 
-void set_uniform_mat4f(Shader shader, const char *name, mat4 mat) {
+void set_uniform_mat4f(Shader shader, const char *name, const mat4 mat) {
 	glUniformMatrix4fv(glGetUniformLocation(shader, name), 1, GL_TRUE, mat);
 }
 
+void set_uniform_block_binding(Shader shader, const char *name, unsigned int binding) {
+	glUniformBlockBinding(shader, glGetUniformBlockIndex(shader, name), binding);
+}
+
 
 /*
 * check_shader_compilation: Helper function to check if shader compiled successfully in OpenGL
@@ -49,6 +49,15 @@ void set_uniform_float(Shader shader, const char *name, float value);
 * @param[in] name: name of uniform
 * @param[in] value: value of uniform
 */
-void set_uniform_mat4f(Shader shader, const char *name, mat4 mat);
+void set_uniform_mat4f(Shader shader, const char *name, const mat4 mat);
+
+/*
+* set_uniform_block_binding: Connect a uniform block in a shader program to a uniform buffer binding point
+*
+* @param[in] shader: shader program to configure
+* @param[in] name: name of uniform block
+* @param[in] binding: binding point index, as used with glBindBufferBase
+*/
+void set_uniform_block_binding(Shader shader, const char *name, unsigned int binding);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "simulation.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "window.h"
+#include "mouse_handler.h"
+#include "snapshot.h"
+#include "timer.h"
+#include "camera.h"
+#include "cube.h"
+#include "animation.h"
+#include "moves.h"
+#include "two_phase.h"
+
+#define SOLVE_MAX_LENGTH 22
+// Spent looking for a shorter solution once one is found
+#define SOLVE_TIME_BUDGET_NS (50 * NS_PER_MS)
+
+static uint64_t step = 0;
+
+void simulation_init() {
+    cube_init_data();
+    simulation_publish();
+}
+
+void simulation_step() {
+    mouse_process_input();
+    animation_update(STEP_NS);
+    cube_update();
+    step++;
+    simulation_publish();
+}
+
+int simulation_queue_moves(const char *notation, int solve) {
+    uint8_t moves[ANIMATION_QUEUE_CAPACITY];
+    if (notation) {
+        long count = moves_parse(notation, strlen(notation), moves, ANIMATION_QUEUE_CAPACITY, NULL);
+        if ((count < 0) || !animation_queue(moves, (size_t)count)) {
+            printf("Can't queue moves \"%s\": invalid notation or more than %d moves\n", notation, ANIMATION_QUEUE_CAPACITY);
+            return 0;
+        }
+    }
+
+    if (solve) {
+        // Solve the cube as it will be once everything queued so far has played
+        cube_state state;
+        animation_final_state(&state);
+        int count = two_phase_init(NULL) ? two_phase_solve(&state, SOLVE_MAX_LENGTH, SOLVE_TIME_BUDGET_NS, moves) : -1;
+        if ((count < 0) || !animation_queue(moves, (size_t)count)) {
+            printf("Can't queue a solution\n");
+            return 0;
+        }
+        char text[TWO_PHASE_MAX_MOVES * 4];
+        moves_format(moves, (size_t)count, text, sizeof(text));
+        printf("Solution (%d moves): %s\n", count, text);
+    }
+    return 1;
+}
+
+void simulation_publish() {
+    frame_snapshot *snapshot = snapshot_write_slot();
+
+    snapshot->step = step;
+    snapshot->time_ns = timer_now_ns();
+    snapshot->step_ns = STEP_NS;
+
+    // Camera & projection
+    int width = window_width(), height = window_height();
+    snapshot->viewport_width = width;
+    snapshot->viewport_height = height;
+    look_at(*cube_pos());
+    get_view_matrix(snapshot->view);
+    get_perspective_matrix(60.f, (height > 0) ? (float)width / (float)height : 1.f, 0.1f, 100.f, snapshot->projection);
+
+    // Cube
+    vec3_copy(snapshot->cube_pos, *cube_pos());
+    snapshot->orientation[0] = cube_tick_orientations()[0];
+    snapshot->orientation[1] = cube_tick_orientations()[1];
+    memcpy(snapshot->cubie_transform, cube_cubie_transforms(), sizeof(snapshot->cubie_transform));
+    cube_sticker_colours(snapshot->sticker_colour);
+
+    snapshot_publish();
+}
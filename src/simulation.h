@@ -0,0 +1,30 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdint.h>
+
+#include "timer.h"
+
+#define UPDATES_PER_SECOND 120
+#define STEP_NS (NS_PER_SEC / UPDATES_PER_SECOND)
+
+// Sets up the simulation state and publishes the first snapshot
+void simulation_init();
+
+// Fixed-rate simulation step: applies queued input, advances the cube and publishes a snapshot
+void simulation_step();
+
+// Publishes a snapshot of the current state without advancing it
+void simulation_publish();
+
+/*
+* simulation_queue_moves: Queues moves for the cube to play as animated turns
+*
+* @param[in] notation: moves in Singmaster notation, NULL for none
+* @param[in] solve: if set, then queues a two-phase solution of the cube as it will be after every queued move
+*
+* @return 1 if successful, 0 if the notation is invalid, no solution was found or the queue is full
+*/
+int simulation_queue_moves(const char *notation, int solve);
+
+#endif // !SIMULATION_H
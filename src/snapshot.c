@@ -0,0 +1,36 @@
+#include "snapshot.h"
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Low bits of the shared word index a slot, FRESH marks a slot published but not yet read
+#define INDEX_MASK 3u
+#define FRESH 4u
+
+static frame_snapshot slots[3];
+static _Atomic unsigned int shared = 1;
+static unsigned int write_index = 0;    // owned by the simulation thread
+static unsigned int read_index = 2;     // owned by the render thread
+static int has_read = 0;                // owned by the render thread
+
+frame_snapshot *snapshot_write_slot() {
+    return &slots[write_index];
+}
+
+void snapshot_publish() {
+    // Release our writes to the reader, acquire the slot it gave back
+    unsigned int previous = atomic_exchange_explicit(&shared, write_index | FRESH, memory_order_acq_rel);
+    write_index = previous & INDEX_MASK;
+}
+
+const frame_snapshot *snapshot_read(int *fresh) {
+    int is_fresh = 0;
+    if (atomic_load_explicit(&shared, memory_order_relaxed) & FRESH) {
+        unsigned int previous = atomic_exchange_explicit(&shared, read_index, memory_order_acq_rel);
+        read_index = previous & INDEX_MASK;
+        has_read = 1;
+        is_fresh = 1;
+    }
+    if (fresh) *fresh = is_fresh;
+    return has_read ? &slots[read_index] : NULL;
+}
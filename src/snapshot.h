@@ -0,0 +1,55 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "cube.h"
+
+/*
+* Immutable picture of everything the renderer needs for one frame. The simulation thread fills one per step and
+* publishes it; the render thread only ever reads the latest published one.
+*/
+typedef struct {
+    uint64_t step;                          // simulation step that produced this snapshot
+    uint64_t time_ns;                       // when it was published (timer_now_ns)
+    uint64_t step_ns;                       // simulation step length, for interpolation
+
+    int viewport_width;
+    int viewport_height;
+    mat4 view;
+    mat4 projection;
+
+    vec3 cube_pos;
+    quaternion orientation[2];              // cube orientation at the previous and at this step
+    mat4 cubie_transform[NUM_CUBES];       // per-cubie transform relative to the cube
+    unsigned char sticker_colour[NUM_CUBES * FACES_PER_CUBE];
+} frame_snapshot;
+
+/*
+* Single-producer single-consumer triple buffer. The writer and the reader each own one slot and the third is
+* handed between them with an atomic exchange, so neither side ever blocks or sees a half-written snapshot.
+*/
+
+/*
+* snapshot_write_slot: Slot the simulation thread fills next. Every field must be rewritten, the slot holds
+* whatever was published two snapshots ago.
+*
+* @return Writer-owned snapshot
+*/
+frame_snapshot *snapshot_write_slot();
+
+// Publishes the write slot, making it the latest snapshot
+void snapshot_publish();
+
+/*
+* snapshot_read: Takes the latest published snapshot, if a newer one exists than the one last returned.
+*
+* @param[out] fresh: set to 1 if the returned snapshot was not returned before, may be NULL
+*
+* @return Reader-owned snapshot, valid until the next call. NULL if nothing was published yet
+*/
+const frame_snapshot *snapshot_read(int *fresh);
+
+#endif // !SNAPSHOT_H
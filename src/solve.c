@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timer.h"
+#include "stats.h"
+#include "moves.h"
+#include "cube_state.h"
+#include "two_phase.h"
+#include "korf.h"
+#include "thread.h"
+
+/*
+* Batch solver. Reads one cube per line, either a scramble in move notation or 54 facelets in the
+* cube_state_to_facelets layout, solves the lines concurrently and writes one solution per line in input order.
+* Lines that can't be read or solved come out as "error: <reason>". Blank lines and lines starting with # are
+* passed through unchanged. A summary with throughput and latency percentiles goes to stderr at the end.
+*
+* usage: rubix_solve [--input FILE] [--output FILE] [--threads N] [--window N] [--max-length N]
+*                    [--time-budget MS] [--optimal] [--tables DIR]
+*/
+
+#define LINE_CAPACITY 1024
+#define MAX_SCRAMBLE_MOVES 512
+#define SOLUTION_CAPACITY 256
+#define MAX_THREADS 256
+#define DEFAULT_WINDOW 4096
+#define DEFAULT_MAX_LENGTH 22
+#define LATENCY_SAMPLES (1 << 20)
+
+typedef enum {
+    SLOT_FREE,
+    SLOT_READ,          // waiting for a worker
+    SLOT_SOLVING,
+    SLOT_DONE           // waiting for the writer
+} slot_state;
+
+typedef struct {
+    slot_state state;
+    char line[LINE_CAPACITY];
+    char result[SOLUTION_CAPACITY];
+    uint64_t read_ns;
+    uint64_t done_ns;
+} slot;
+
+typedef struct {
+    const char *input;
+    const char *output;
+    int threads;
+    unsigned int window;
+    int max_length;
+    uint64_t time_budget_ns;
+    int optimal;
+    const char *table_dir;
+} solve_options;
+
+/*
+* Lines in flight live in a ring of window slots, indexed by line number modulo the window. The reader stalls once
+* it is a whole window ahead of the writer, so a slow line holds back at most that many finished ones.
+*/
+typedef struct {
+    slot *slots;
+    unsigned int window;
+    thread_mutex lock;
+    thread_cond line_read;          // a slot was filled or the input ended
+    thread_cond line_done;          // a slot was solved
+    thread_cond slot_freed;         // the writer moved on
+    uint64_t next_read;
+    uint64_t next_solve;
+    uint64_t next_write;
+    int input_done;
+
+    const solve_options *options;
+    FILE *out;
+    sample_ring latency;
+    unsigned long solved;
+    unsigned long failed;
+} batch;
+
+static int parse_args(int argc, char **argv, solve_options *options);
+
+static int is_blank_or_comment(const char *line) {
+    while ((*line == ' ') || (*line == '\t')) line++;
+    return (*line == '\0') || (*line == '#');
+}
+
+// Solves one line into its result text, returns 1 if it produced a solution
+static int solve_line(const solve_options *options, const char *line, char *result) {
+    size_t length = strlen(line);
+    while ((length > 0) && ((line[length - 1] == ' ') || (line[length - 1] == '\t'))) length--;
+    while ((length > 0) && ((*line == ' ') || (*line == '\t'))) {
+        line++;
+        length--;
+    }
+
+    // 54 face letters and nothing else is facelets, as a scramble it would be 54 unseparated quarter turns
+    cube_state state;
+    if ((length == NUM_FACELETS) && (strspn(line, "URFDLB") == NUM_FACELETS)) {
+        if (!cube_state_from_facelets(line, &state)) {
+            snprintf(result, SOLUTION_CAPACITY, "error: facelets don't describe a reachable cube");
+            return 0;
+        }
+    }
+    else {
+        uint8_t scramble[MAX_SCRAMBLE_MOVES];
+        size_t error_offset;
+        long count = moves_parse(line, length, scramble, MAX_SCRAMBLE_MOVES, &error_offset);
+        if (count < 0) {
+            if (error_offset < length) snprintf(result, SOLUTION_CAPACITY, "error: invalid notation at column %zu", error_offset + 1);
+            else snprintf(result, SOLUTION_CAPACITY, "error: more than %d moves", MAX_SCRAMBLE_MOVES);
+            return 0;
+        }
+        cube_state_solved(&state);
+        cube_state_apply_moves(&state, scramble, (size_t)count);
+    }
+
+    uint8_t moves[TWO_PHASE_MAX_MOVES > KORF_MAX_MOVES ? TWO_PHASE_MAX_MOVES : KORF_MAX_MOVES];
+    int count;
+    if (options->optimal) count = korf_solve(&state, options->max_length, options->time_budget_ns, moves, NULL);
+    else count = two_phase_solve(&state, options->max_length, options->time_budget_ns, moves);
+    if (count < 0) {
+        snprintf(result, SOLUTION_CAPACITY, "error: %s", cube_state_is_valid(&state) ? "no solution within the limits" : "unreachable cube");
+        return 0;
+    }
+    moves_format(moves, (size_t)count, result, SOLUTION_CAPACITY);
+    return 1;
+}
+
+static void *solve_worker(void *arg) {
+    batch *b = arg;
+    thread_mutex_lock(&b->lock);
+    for (;;) {
+        while ((b->next_solve == b->next_read) && !b->input_done) thread_cond_wait(&b->line_read, &b->lock);
+        if (b->next_solve == b->next_read) break;
+
+        slot *s = &b->slots[b->next_solve++ % b->window];
+        s->state = SLOT_SOLVING;
+        thread_mutex_unlock(&b->lock);
+
+        int solved = is_blank_or_comment(s->line) || solve_line(b->options, s->line, s->result);
+        uint64_t done_ns = timer_now_ns();
+
+        thread_mutex_lock(&b->lock);
+        s->done_ns = done_ns;
+        s->state = SLOT_DONE;
+        if (!is_blank_or_comment(s->line)) {
+            if (solved) b->solved++;
+            else b->failed++;
+        }
+        thread_cond_broadcast(&b->line_done);
+    }
+    thread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+// Writes finished lines in input order until the input is exhausted and every line is out
+static void *write_worker(void *arg) {
+    batch *b = arg;
+    thread_mutex_lock(&b->lock);
+    for (;;) {
+        slot *s = &b->slots[b->next_write % b->window];
+        while ((b->next_write < b->next_read) ? (s->state != SLOT_DONE) : !b->input_done) thread_cond_wait(&b->line_done, &b->lock);
+        if (b->next_write == b->next_read) break;
+        thread_mutex_unlock(&b->lock);
+
+        // The slot stays ours until next_write moves past it
+        fputs(is_blank_or_comment(s->line) ? s->line : s->result, b->out);
+        fputc('\n', b->out);
+
+        thread_mutex_lock(&b->lock);
+        if (!is_blank_or_comment(s->line)) sample_ring_push(&b->latency, s->done_ns - s->read_ns);
+        s->state = SLOT_FREE;
+        b->next_write++;
+        thread_cond_signal(&b->slot_freed);
+    }
+    thread_mutex_unlock(&b->lock);
+    fflush(b->out);
+    return NULL;
+}
+
+// Reads the next line into slot, dropping the newline. Overlong lines are cut short so they fail to parse.
+static int read_line(FILE *in, slot *s) {
+    if (fgets(s->line, LINE_CAPACITY, in) == NULL) return 0;
+    size_t length = strcspn(s->line, "\r\n");
+    int truncated = 0;
+    if ((s->line[length] == '\0') && (length == LINE_CAPACITY - 1)) {
+        // The buffer filled up before the newline, the line is only too long if more than a line ending is left
+        int c;
+        while (((c = fgetc(in)) != EOF) && (c != '\n')) truncated |= (c != '\r');
+    }
+    s->line[length] = '\0';
+    if (truncated) s->line[LINE_CAPACITY - 2] = '!';   // not valid notation, reported as an error
+    return 1;
+}
+
+static void print_summary(batch *b, uint64_t elapsed_ns) {
+    sample_summary latency = sample_ring_summary(&b->latency);
+    double seconds = (double)elapsed_ns / NS_PER_SEC;
+    fprintf(stderr, "%lu solved, %lu failed in %.2f s, %.1f cubes/s on %d threads\n", b->solved, b->failed, seconds,
+        (seconds > 0.0) ? (double)(b->solved + b->failed) / seconds : 0.0, b->options->threads);
+    fprintf(stderr, "latency ms: min %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  mean %.2f\n",
+        (double)latency.min / NS_PER_MS, (double)latency.p50 / NS_PER_MS, (double)latency.p95 / NS_PER_MS,
+        (double)latency.p99 / NS_PER_MS, (double)latency.max / NS_PER_MS, latency.mean / NS_PER_MS);
+}
+
+int main(int argc, char **argv) {
+    solve_options options = { NULL, NULL, 0, DEFAULT_WINDOW, DEFAULT_MAX_LENGTH, 0, 0, NULL };
+    if (!parse_args(argc, argv, &options)) return 1;
+    if (options.threads <= 0) options.threads = thread_cpu_count();
+    if (options.threads > MAX_THREADS) options.threads = MAX_THREADS;
+    if (options.window < (unsigned int)options.threads) options.window = (unsigned int)options.threads;
+
+    FILE *in = options.input ? fopen(options.input, "r") : stdin;
+    if (in == NULL) {
+        fprintf(stderr, "Couldn't open %s\n", options.input);
+        return 1;
+    }
+    FILE *out = options.output ? fopen(options.output, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Couldn't create %s\n", options.output);
+        if (in != stdin) fclose(in);
+        return 1;
+    }
+
+    cube_state_init();
+    if (!(options.optimal ? korf_init(options.table_dir) : two_phase_init(options.table_dir))) {
+        fprintf(stderr, "Couldn't load the solver tables\n");
+        return 1;
+    }
+
+    batch b;
+    memset(&b, 0, sizeof(b));
+    b.window = options.window;
+    b.options = &options;
+    b.out = out;
+    b.slots = calloc(b.window, sizeof(slot));
+    if ((b.slots == NULL) || !sample_ring_init(&b.latency, LATENCY_SAMPLES)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    thread_mutex_init(&b.lock);
+    thread_cond_init(&b.line_read);
+    thread_cond_init(&b.line_done);
+    thread_cond_init(&b.slot_freed);
+
+    uint64_t start_ns = timer_now_ns();
+    thread_handle workers[MAX_THREADS], writer;
+    int started = 0;
+    for (; started < options.threads; started++) {
+        if (!thread_create(&workers[started], solve_worker, &b)) break;
+    }
+    int status = 0;
+    if ((started == 0) || (!thread_create(&writer, write_worker, &b))) {
+        fprintf(stderr, "Couldn't start the worker threads\n");
+        status = 1;
+    }
+
+    // This thread reads, filling a slot at a time once the writer has freed it
+    thread_mutex_lock(&b.lock);
+    while (status == 0) {
+        slot *s = &b.slots[b.next_read % b.window];
+        while (s->state != SLOT_FREE) thread_cond_wait(&b.slot_freed, &b.lock);
+        thread_mutex_unlock(&b.lock);
+
+        int more = read_line(in, s);
+        uint64_t read_ns = timer_now_ns();
+
+        thread_mutex_lock(&b.lock);
+        if (!more) break;
+        s->read_ns = read_ns;
+        s->state = SLOT_READ;
+        b.next_read++;
+        thread_cond_signal(&b.line_read);
+    }
+    b.input_done = 1;
+    thread_cond_broadcast(&b.line_read);
+    thread_cond_broadcast(&b.line_done);
+    thread_mutex_unlock(&b.lock);
+
+    for (int i = 0; i < started; i++) thread_join(workers[i]);
+    if (status == 0) {
+        thread_join(writer);
+        options.threads = started;
+        print_summary(&b, timer_now_ns() - start_ns);
+        if (ferror(out)) {
+            fprintf(stderr, "Couldn't write the solutions\n");
+            status = 1;
+        }
+    }
+
+    thread_cond_destroy(&b.slot_freed);
+    thread_cond_destroy(&b.line_done);
+    thread_cond_destroy(&b.line_read);
+    thread_mutex_destroy(&b.lock);
+    sample_ring_free(&b.latency);
+    free(b.slots);
+    if (in != stdin) fclose(in);
+    if ((out != stdout) && (fclose(out) != 0)) status = 1;
+    return status;
+}
+
+static int parse_args(int argc, char **argv, solve_options *options) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--input") && (i + 1 < argc)) options->input = argv[++i];
+        else if (!strcmp(argv[i], "--output") && (i + 1 < argc)) options->output = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && (i + 1 < argc)) options->threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--window") && (i + 1 < argc)) options->window = (unsigned int)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-length") && (i + 1 < argc)) options->max_length = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--time-budget") && (i + 1 < argc)) options->time_budget_ns = (uint64_t)atoi(argv[++i]) * NS_PER_MS;
+        else if (!strcmp(argv[i], "--optimal")) options->optimal = 1;
+        else if (!strcmp(argv[i], "--tables") && (i + 1 < argc)) options->table_dir = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--input FILE] [--output FILE] [--threads N] [--window N] [--max-length N]\n"
+                "       [--time-budget MS] [--optimal] [--tables DIR]\n", argv[0]);
+            return 0;
+        }
+    }
+    return 1;
+}
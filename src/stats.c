@@ -0,0 +1,74 @@
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static uint64_t percentile(const uint64_t *sorted, unsigned int count, unsigned int pct) {
+    unsigned int rank = (unsigned int)(((uint64_t)pct * count + 99) / 100);
+    if (rank == 0) rank = 1;
+    return sorted[rank - 1];
+}
+
+int sample_ring_init(sample_ring *ring, unsigned int capacity) {
+    ring->samples = malloc(sizeof(uint64_t) * capacity);
+    ring->capacity = ring->samples ? capacity : 0;
+    ring->count = 0;
+    ring->next = 0;
+    return ring->samples != NULL;
+}
+
+void sample_ring_free(sample_ring *ring) {
+    free(ring->samples);
+    ring->samples = NULL;
+    ring->capacity = ring->count = ring->next = 0;
+}
+
+void sample_ring_push(sample_ring *ring, uint64_t sample) {
+    if (ring->capacity == 0) return;
+    ring->samples[ring->next] = sample;
+    ring->next = (ring->next + 1) % ring->capacity;
+    if (ring->count < ring->capacity) ring->count++;
+}
+
+void sample_ring_clear(sample_ring *ring) {
+    ring->count = 0;
+    ring->next = 0;
+}
+
+sample_summary sample_ring_summary(const sample_ring *ring) {
+    sample_summary summary = { 0 };
+    if (ring->count == 0) return summary;
+
+    uint64_t *sorted = malloc(sizeof(uint64_t) * ring->count);
+    if (sorted == NULL) return summary;
+    memcpy(sorted, ring->samples, sizeof(uint64_t) * ring->count);
+    summary = summarise_samples(sorted, ring->count);
+    free(sorted);
+    return summary;
+}
+
+sample_summary summarise_samples(uint64_t *samples, unsigned int count) {
+    sample_summary summary = { 0 };
+    if (count == 0) return summary;
+
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+
+    double total = 0;
+    for (unsigned int i = 0; i < count; i++) total += (double)samples[i];
+
+    summary.count = count;
+    summary.min = samples[0];
+    summary.p50 = percentile(samples, count, 50);
+    summary.p95 = percentile(samples, count, 95);
+    summary.p99 = percentile(samples, count, 99);
+    summary.max = samples[count - 1];
+    summary.mean = total / count;
+    return summary;
+}
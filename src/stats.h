@@ -0,0 +1,62 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/*
+* Fixed-capacity ring of timing samples. Once full, new samples overwrite the oldest, so the summary always
+* describes the most recent window.
+*/
+typedef struct {
+    uint64_t *samples;
+    unsigned int capacity;
+    unsigned int count;     // valid samples, at most capacity
+    unsigned int next;      // slot the next sample goes into
+} sample_ring;
+
+typedef struct {
+    unsigned int count;
+    uint64_t min;
+    uint64_t p50;
+    uint64_t p95;
+    uint64_t p99;
+    uint64_t max;
+    double mean;
+} sample_summary;
+
+/*
+* sample_ring_init: Allocates a sample ring
+*
+* @param[out] ring: ring to initialize
+* @param[in] capacity: maximum number of samples kept
+*
+* @return 1 if successful, 0 otherwise
+*/
+int sample_ring_init(sample_ring *ring, unsigned int capacity);
+
+void sample_ring_free(sample_ring *ring);
+
+void sample_ring_push(sample_ring *ring, uint64_t sample);
+
+void sample_ring_clear(sample_ring *ring);
+
+/*
+* sample_ring_summary: Computes order statistics over the samples currently in the ring
+*
+* @param[in] ring: samples to summarise
+*
+* @return Summary, all zero when the ring is empty
+*/
+sample_summary sample_ring_summary(const sample_ring *ring);
+
+/*
+* summarise_samples: Computes order statistics over an array of samples. Sorts the array in place.
+*
+* @param[in, out] samples: samples to summarise
+* @param[in] count: number of samples
+*
+* @return Summary, all zero when count is 0
+*/
+sample_summary summarise_samples(uint64_t *samples, unsigned int count);
+
+#endif // !STATS_H
@@ -0,0 +1,96 @@
+#include "stream_buffer.h"
+
+#include <stdio.h>
+
+#include <glad/gl.h>
+
+// A fence not signalled by then means the GPU has hung, give up waiting rather than freeze with it
+#define FENCE_TIMEOUT_NS 1000000000ull
+
+#define PERSISTENT_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+int stream_buffer_init(stream_buffer *stream, unsigned int target, size_t region_size, size_t alignment) {
+    stream->target = target;
+    stream->alignment = alignment ? alignment : 1;
+    stream->region_size = (region_size + stream->alignment - 1) / stream->alignment * stream->alignment;
+    stream->region = 0;
+    stream->used = 0;
+    stream->persistent = NULL;
+    for (int i = 0; i < STREAM_BUFFER_REGIONS; i++) stream->fences[i] = NULL;
+
+    GLsizeiptr size = (GLsizeiptr)(stream->region_size * STREAM_BUFFER_REGIONS);
+    glGenBuffers(1, &stream->buffer);
+    glBindBuffer(target, stream->buffer);
+    if (GLAD_GL_ARB_buffer_storage) {
+        glBufferStorage(target, size, NULL, PERSISTENT_FLAGS);
+        stream->persistent = glMapBufferRange(target, 0, size, PERSISTENT_FLAGS);
+        if (stream->persistent) return 1;
+
+        // Immutable storage can't be orphaned, start over with a mutable buffer
+        glDeleteBuffers(1, &stream->buffer);
+        glGenBuffers(1, &stream->buffer);
+        glBindBuffer(target, stream->buffer);
+    }
+    glBufferData(target, size, NULL, GL_STREAM_DRAW);
+    return 1;
+}
+
+void stream_buffer_free(stream_buffer *stream) {
+    for (int i = 0; i < STREAM_BUFFER_REGIONS; i++) {
+        if (stream->fences[i]) glDeleteSync((GLsync)stream->fences[i]);
+        stream->fences[i] = NULL;
+    }
+    if (stream->persistent) {
+        glBindBuffer(stream->target, stream->buffer);
+        glUnmapBuffer(stream->target);
+        stream->persistent = NULL;
+    }
+    glDeleteBuffers(1, &stream->buffer);
+}
+
+// Blocks until the GPU has finished the draws of the region's previous frame, normally long since done
+static void wait_for_region(stream_buffer *stream, int region) {
+    GLsync fence = (GLsync)stream->fences[region];
+    if (fence == NULL) return;
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+    if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED)) printf("Stream buffer fence wait failed\n");
+    glDeleteSync(fence);
+    stream->fences[region] = NULL;
+}
+
+void *stream_buffer_map(stream_buffer *stream, size_t size, size_t *offset) {
+    size_t start = (stream->used + stream->alignment - 1) / stream->alignment * stream->alignment;
+    if (start + size > stream->region_size) return NULL;
+
+    glBindBuffer(stream->target, stream->buffer);
+    if ((start == 0) && stream->persistent) wait_for_region(stream, stream->region);
+
+    *offset = (size_t)stream->region * stream->region_size + start;
+    stream->used = start + size;
+    if (stream->persistent) return stream->persistent + *offset;
+    return glMapBufferRange(stream->target, (GLintptr)*offset, (GLsizeiptr)size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void stream_buffer_unmap(stream_buffer *stream) {
+    // Coherent mappings need nothing, the writes are visible to commands issued after them
+    if (stream->persistent) return;
+    glBindBuffer(stream->target, stream->buffer);
+    glUnmapBuffer(stream->target);
+}
+
+void stream_buffer_end_frame(stream_buffer *stream) {
+    if (stream->persistent && (stream->used > 0)) {
+        if (stream->fences[stream->region]) glDeleteSync((GLsync)stream->fences[stream->region]);
+        stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    stream->region = (stream->region + 1) % STREAM_BUFFER_REGIONS;
+    stream->used = 0;
+
+    // Without fences, orphan on wrapping: draws still reading the old storage keep it, and the new storage is free
+    // to write unsynchronized
+    if (!stream->persistent && (stream->region == 0)) {
+        glBindBuffer(stream->target, stream->buffer);
+        glBufferData(stream->target, (GLsizeiptr)(stream->region_size * STREAM_BUFFER_REGIONS), NULL, GL_STREAM_DRAW);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <stddef.h>
+
+// Frames the GPU may still be reading while the CPU writes the next one
+#define STREAM_BUFFER_REGIONS 3
+
+/*
+* Ring of per-frame regions in one GL buffer, for data rewritten every frame. Each frame writes into its own region
+* while the GPU reads the previous ones, so no upload waits for the draws still using the buffer.
+*
+* With GL_ARB_buffer_storage the whole buffer stays mapped (persistent and coherent) and a fence set at the end of
+* each frame guards its region, waited on only if the ring comes round to it before the GPU is done. Without it
+* (the GL 3.3 baseline) each write maps its range with GL_MAP_UNSYNCHRONIZED_BIT and GL_MAP_INVALIDATE_RANGE_BIT,
+* and the buffer is orphaned whenever the ring wraps, the driver keeping the old storage alive for pending draws.
+*/
+typedef struct {
+    unsigned int buffer;
+    unsigned int target;
+    size_t region_size;
+    size_t alignment;
+    int region;                             // region written this frame
+    size_t used;                            // bytes of it handed out so far
+    unsigned char *persistent;              // whole buffer, NULL when mapping range by range
+    void *fences[STREAM_BUFFER_REGIONS];    // GLsync set once each region's draws were issued
+} stream_buffer;
+
+/*
+* stream_buffer_init: Creates the buffer, needs a current GL context
+*
+* @param[out] stream: buffer to initialize
+* @param[in] target: binding target used to map and fill it, e.g. GL_UNIFORM_BUFFER
+* @param[in] region_size: most bytes written in a frame
+* @param[in] alignment: every allocation starts at a multiple of this, e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+*
+* @return 1 if successful, 0 otherwise
+*/
+int stream_buffer_init(stream_buffer *stream, unsigned int target, size_t region_size, size_t alignment);
+
+void stream_buffer_free(stream_buffer *stream);
+
+/*
+* stream_buffer_map: Hands out space in this frame's region. Leaves the buffer bound to its target.
+*
+* @param[in] stream: buffer to write
+* @param[in] size: bytes to write
+* @param[out] offset: where the space starts in the buffer, for glBindBufferRange or attribute offsets
+*
+* @return Pointer to write through until stream_buffer_unmap, NULL if the region is full or mapping failed
+*/
+void *stream_buffer_map(stream_buffer *stream, size_t size, size_t *offset);
+
+// Finishes the writes of the last stream_buffer_map, before any draw reads them
+void stream_buffer_unmap(stream_buffer *stream);
+
+// Fences this frame's region after its last draw is issued and moves on to the next region
+void stream_buffer_end_frame(stream_buffer *stream);
+
+#endif // !STREAM_BUFFER_H
@@ -0,0 +1,209 @@
+#include "symmetry.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "coordinates.h"
+
+static cube_state symmetries[NUM_SYMMETRIES];
+static uint8_t inverse[NUM_SYMMETRIES];
+static uint8_t conjugate_move[NUM_SYMMETRIES][NUM_MOVES];
+
+static int initialized = 0;
+
+// Reflection in the plane through the U, D, F and B centres, swapping the L and R sides
+static const cube_state mirror_lr = {
+    { CORNER_UFL, CORNER_URF, CORNER_UBR, CORNER_ULB, CORNER_DLF, CORNER_DFR, CORNER_DRB, CORNER_DBL },
+    { 3, 3, 3, 3, 3, 3, 3, 3 },
+    { EDGE_UL, EDGE_UF, EDGE_UR, EDGE_UB, EDGE_DL, EDGE_DF, EDGE_DR, EDGE_DB, EDGE_FL, EDGE_FR, EDGE_BR, EDGE_BL },
+    { 0 },
+    { FACE_U, FACE_L, FACE_F, FACE_D, FACE_R, FACE_B }
+};
+
+void symmetry_multiply(const cube_state *a, const cube_state *b, cube_state *result) {
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        uint8_t from = b->cp[i];
+        int twist_a = a->co[from], twist_b = b->co[i], twist;
+        result->cp[i] = a->cp[from];
+
+        // Orientations 3 to 5 are mirrored; a mirror reverses the sense of the twists that follow it
+        if ((twist_a < 3) && (twist_b < 3)) twist = (twist_a + twist_b) % 3;
+        else if (twist_a < 3) twist = 3 + (twist_a + twist_b - 3) % 3;
+        else if (twist_b < 3) twist = 3 + (twist_a - 3 - twist_b + 3) % 3;
+        else twist = (twist_a - twist_b + 3) % 3;
+        result->co[i] = (uint8_t)twist;
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        uint8_t from = b->ep[i];
+        result->ep[i] = a->ep[from];
+        result->eo[i] = a->eo[from] ^ b->eo[i];
+    }
+    for (int i = 0; i < NUM_FACES; i++) result->centres[i] = a->centres[b->centres[i]];
+}
+
+void symmetry_init() {
+    if (initialized) return;
+
+    // URF3 is x then y, F2 is z2 and U4 is y: the move tables already hold them
+    cube_state urf3;
+    cube_state_solved(&urf3);
+    const uint8_t urf3_moves[] = { MOVE(MOVE_X, 1), MOVE(MOVE_Y, 1) };
+    cube_state_apply_moves(&urf3, urf3_moves, 2);
+    const cube_state *f2 = cube_state_move(MOVE(MOVE_Z, 2));
+    const cube_state *u4 = cube_state_move(MOVE(MOVE_Y, 1));
+
+    cube_state current, next;
+    cube_state_solved(&current);
+    int s = 0;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 2; j++) {
+            for (int k = 0; k < 4; k++) {
+                for (int l = 0; l < 2; l++) {
+                    symmetries[s++] = current;
+                    symmetry_multiply(&current, &mirror_lr, &next);
+                    current = next;
+                }
+                symmetry_multiply(&current, u4, &next);
+                current = next;
+            }
+            symmetry_multiply(&current, f2, &next);
+            current = next;
+        }
+        symmetry_multiply(&current, &urf3, &next);
+        current = next;
+    }
+
+    for (int i = 0; i < NUM_SYMMETRIES; i++) {
+        for (int j = 0; j < NUM_SYMMETRIES; j++) {
+            symmetry_multiply(&symmetries[i], &symmetries[j], &next);
+            if (cube_state_is_solved(&next)) {
+                inverse[i] = (uint8_t)j;
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_SYMMETRIES; i++) {
+        for (int m = 0; m < NUM_MOVES; m++) {
+            symmetry_conjugate(cube_state_move((uint8_t)m), i, &next);
+            for (int n = 0; n < NUM_MOVES; n++) {
+                if (memcmp(&next, cube_state_move((uint8_t)n), sizeof(cube_state)) == 0) {
+                    conjugate_move[i][m] = (uint8_t)n;
+                    break;
+                }
+            }
+        }
+    }
+
+    initialized = 1;
+}
+
+const cube_state *symmetry_cube(int s) {
+    return &symmetries[s];
+}
+
+int symmetry_inverse(int s) {
+    return inverse[s];
+}
+
+void symmetry_conjugate(const cube_state *state, int s, cube_state *result) {
+    cube_state product;
+    symmetry_multiply(&symmetries[s], state, &product);
+    symmetry_multiply(&product, &symmetries[inverse[s]], result);
+}
+
+uint8_t symmetry_conjugate_move(int s, uint8_t move) {
+    return conjugate_move[s][move];
+}
+
+void symmetry_coord_table(uint16_t *table, unsigned int count, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), int num_syms) {
+    cube_state state, conjugate;
+    for (unsigned int c = 0; c < count; c++) {
+        cube_state_solved(&state);
+        set(&state, c);
+        for (int s = 0; s < num_syms; s++) {
+            symmetry_conjugate(&state, s, &conjugate);
+            table[c * (unsigned int)num_syms + (unsigned int)s] = (uint16_t)get(&conjugate);
+        }
+    }
+}
+
+int sym_coord_build(sym_coord *coord, uint32_t num_raw, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), int num_syms) {
+    coord->num_raw = num_raw;
+    coord->num_classes = 0;
+    coord->num_syms = num_syms;
+    coord->class_of = malloc(num_raw * sizeof(uint32_t));
+    coord->sym_of = malloc(num_raw);
+    coord->representative = NULL;
+    coord->self_symmetries = NULL;
+    if ((coord->class_of == NULL) || (coord->sym_of == NULL)) {
+        sym_coord_free(coord);
+        return 0;
+    }
+    for (uint32_t i = 0; i < num_raw; i++) coord->class_of[i] = UINT32_MAX;
+
+    // Representatives are found in raw order, so there is no telling how many classes there are until the end
+    uint32_t capacity = 1024;
+    coord->representative = malloc(capacity * sizeof(uint32_t));
+    coord->self_symmetries = malloc(capacity * sizeof(uint64_t));
+    if ((coord->representative == NULL) || (coord->self_symmetries == NULL)) {
+        sym_coord_free(coord);
+        return 0;
+    }
+
+    cube_state state, conjugate;
+    for (uint32_t raw = 0; raw < num_raw; raw++) {
+        if (coord->class_of[raw] != UINT32_MAX) continue;
+
+        if (coord->num_classes == capacity) {
+            capacity *= 2;
+            uint32_t *representative = realloc(coord->representative, capacity * sizeof(uint32_t));
+            if (representative) coord->representative = representative;
+            uint64_t *self_symmetries = realloc(coord->self_symmetries, capacity * sizeof(uint64_t));
+            if (self_symmetries) coord->self_symmetries = self_symmetries;
+            if ((representative == NULL) || (self_symmetries == NULL)) {
+                sym_coord_free(coord);
+                return 0;
+            }
+        }
+
+        uint32_t class = coord->num_classes++;
+        coord->representative[class] = raw;
+        coord->self_symmetries[class] = 0;
+        cube_state_solved(&state);
+        set(&state, raw);
+        for (int s = 0; s < num_syms; s++) {
+            symmetry_conjugate(&state, s, &conjugate);
+            uint32_t other = get(&conjugate);
+            if (other == raw) coord->self_symmetries[class] |= 1ull << s;
+            if (coord->class_of[other] == UINT32_MAX) {
+                // other is S * raw * S^-1, so conjugating other by S^-1 gets back to raw
+                coord->class_of[other] = class;
+                coord->sym_of[other] = inverse[s];
+            }
+        }
+    }
+    return 1;
+}
+
+void sym_coord_free(sym_coord *coord) {
+    free(coord->class_of);
+    free(coord->sym_of);
+    free(coord->representative);
+    free(coord->self_symmetries);
+    coord->class_of = NULL;
+    coord->sym_of = NULL;
+    coord->representative = NULL;
+    coord->self_symmetries = NULL;
+}
+
+unsigned int coord_flipslice(const cube_state *state) {
+    return coord_slice(state) * NUM_FLIPS + coord_flip(state);
+}
+
+void coord_set_flipslice(cube_state *state, unsigned int flipslice) {
+    coord_set_slice(state, flipslice / NUM_FLIPS);
+    coord_set_flip(state, flipslice % NUM_FLIPS);
+}
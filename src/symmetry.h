@@ -0,0 +1,100 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <stdint.h>
+
+#include "cube_state.h"
+
+/*
+* The 48 symmetries of the cube, the 24 rotations and their mirror images. Symmetry s is numbered
+* 16 * urf3 + 8 * f2 + 2 * u4 + lr2, a product of powers of a 120 degree turn about the URF-DBL diagonal, a half
+* turn about the F-B axis, a quarter turn about the U-D axis and the mirror swapping L and R. The first 16 keep the
+* U-D axis, which is all the two-phase coordinates can use as phase 2 singles it out.
+*
+* Two states are equivalent when one is a conjugate of the other, S * a * S^-1 with S applied first. Conjugates are
+* solved by the conjugated solutions, so a table indexed by equivalence class (a sym-coordinate) holds one entry
+* where a raw table holds up to 48.
+*/
+#define NUM_SYMMETRIES 48
+#define NUM_UD_SYMMETRIES 16
+
+#define NUM_FLIPSLICE 1013760           // slice * NUM_FLIPS + flip
+#define NUM_FLIPSLICE_CLASSES 64430     // under the 16 U-D symmetries
+#define NUM_CORNER_CLASSES 2768         // corner permutations under the 16 U-D symmetries
+
+// Builds the symmetry and conjugation tables, call once after cube_state_init
+void symmetry_init();
+
+/*
+* symmetry_cube: The cubie form of a symmetry. Mirrored symmetries have corner orientations 3 to 5, a mirror image
+* followed by that twist, so they are only for symmetry_multiply, not for the other cube_state functions.
+*/
+const cube_state *symmetry_cube(int s);
+
+int symmetry_inverse(int s);
+
+// a followed by b, like cube_state_multiply but also for the mirrored corner orientations of symmetry cubes
+void symmetry_multiply(const cube_state *a, const cube_state *b, cube_state *result);
+
+/*
+* symmetry_conjugate: S * state * S^-1, the state seen through symmetry s
+*
+* @param[in] state: state to conjugate
+* @param[in] s: symmetry
+* @param[out] result: conjugate, may not alias state
+*/
+void symmetry_conjugate(const cube_state *state, int s, cube_state *result);
+
+// The face turn S * move * S^-1, so conjugating a state and then its solution moves by the same s stays in step
+uint8_t symmetry_conjugate_move(int s, uint8_t move);
+
+/*
+* symmetry_coord_table: Tabulates a coordinate under conjugation, for coordinates whose conjugates don't depend on
+* any other aspect of the state (true of twist and the permutation coordinates under the U-D symmetries)
+*
+* @param[out] table: count * num_syms entries, indexed [coordinate * num_syms + symmetry]
+* @param[in] count: number of coordinate values
+* @param[in] get: coordinate getter
+* @param[in] set: coordinate setter
+* @param[in] num_syms: conjugate by symmetries 0..num_syms-1
+*/
+void symmetry_coord_table(uint16_t *table, unsigned int count, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), int num_syms);
+
+/*
+* Sym-coordinate: the equivalence classes of a raw coordinate under a set of symmetries. Each raw value maps to its
+* class and to a symmetry conjugating it into the class representative, and each class records which symmetries
+* leave its representative unchanged (a search only needs one of the moves those symmetries relate).
+*/
+typedef struct {
+    uint32_t num_raw;
+    uint32_t num_classes;
+    int num_syms;
+    uint32_t *class_of;             // [raw]
+    uint8_t *sym_of;                // [raw], symmetry_conjugate by it takes raw to its representative
+    uint32_t *representative;       // [class], the raw value
+    uint64_t *self_symmetries;      // [class], bit s set if symmetry s fixes the representative
+} sym_coord;
+
+/*
+* sym_coord_build: Finds the equivalence classes of a raw coordinate, representatives being the smallest raw value
+* of their class
+*
+* @param[out] coord: classes and maps, allocated here
+* @param[in] num_raw: number of raw values
+* @param[in] get: raw coordinate of a state
+* @param[in] set: state with a raw coordinate, starting from the solved cube
+* @param[in] num_syms: classes under symmetries 0..num_syms-1, NUM_UD_SYMMETRIES or NUM_SYMMETRIES
+*
+* @return 1 if successful, 0 if out of memory
+*/
+int sym_coord_build(sym_coord *coord, uint32_t num_raw, unsigned int (*get)(const cube_state *),
+    void (*set)(cube_state *, unsigned int), int num_syms);
+
+void sym_coord_free(sym_coord *coord);
+
+// Phase 1's slice and flip together, the raw coordinate Kociemba reduces by symmetry
+unsigned int coord_flipslice(const cube_state *state);
+void coord_set_flipslice(cube_state *state, unsigned int flipslice);
+
+#endif // !SYMMETRY_H
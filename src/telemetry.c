@@ -0,0 +1,127 @@
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <glad/gl.h>
+
+#include "stats.h"
+#include "timer.h"
+#include "thread.h"
+
+// Samples kept per phase, about 7 seconds at 144 fps
+#define SAMPLE_CAPACITY 1024
+
+// Frames between issuing a GPU query and reading it back
+#define GPU_QUERY_LATENCY 4
+
+#define REPORT_INTERVAL_NS (5 * NS_PER_SEC)
+
+static const char *phase_names[NUM_PHASES] = {
+    "draw", "poll_events", "swap_buffers", "frame", "gpu"
+};
+
+// Phases are timed on different threads (events on the main thread, drawing on the render thread)
+static thread_mutex rings_mutex = THREAD_MUTEX_INITIALIZER;
+static sample_ring rings[NUM_PHASES];
+static uint64_t phase_start[NUM_PHASES];
+static uint64_t frame_start;
+static uint64_t last_report;
+
+// GPU timer query ring, a slot is reused only once its result has been collected
+static unsigned int queries[GPU_QUERY_LATENCY];
+static int query_pending[GPU_QUERY_LATENCY];
+static int query_active = 0;
+static unsigned int query_next = 0;
+static unsigned long long queries_skipped = 0;
+
+static void collect_gpu_queries();
+
+int telemetry_init() {
+    for (int i = 0; i < NUM_PHASES; i++) {
+        if (!sample_ring_init(&rings[i], SAMPLE_CAPACITY)) return 0;
+    }
+    glGenQueries(GPU_QUERY_LATENCY, queries);
+    frame_start = last_report = timer_now_ns();
+    return 1;
+}
+
+void telemetry_cleanup() {
+    glDeleteQueries(GPU_QUERY_LATENCY, queries);
+    for (int i = 0; i < NUM_PHASES; i++) sample_ring_free(&rings[i]);
+}
+
+void telemetry_begin(telemetry_phase phase) {
+    phase_start[phase] = timer_now_ns();
+}
+
+void telemetry_end(telemetry_phase phase) {
+    uint64_t elapsed = timer_now_ns() - phase_start[phase];
+    thread_mutex_lock(&rings_mutex);
+    sample_ring_push(&rings[phase], elapsed);
+    thread_mutex_unlock(&rings_mutex);
+}
+
+void telemetry_gpu_begin() {
+    // Every slot still in flight: the GPU is more than GPU_QUERY_LATENCY frames behind, skip this frame
+    if (query_pending[query_next]) {
+        queries_skipped++;
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries[query_next]);
+    query_active = 1;
+}
+
+void telemetry_gpu_end() {
+    if (!query_active) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    query_pending[query_next] = 1;
+    query_next = (query_next + 1) % GPU_QUERY_LATENCY;
+    query_active = 0;
+}
+
+void telemetry_end_frame() {
+    uint64_t now = timer_now_ns();
+    thread_mutex_lock(&rings_mutex);
+    sample_ring_push(&rings[PHASE_FRAME], now - frame_start);
+    collect_gpu_queries();
+    thread_mutex_unlock(&rings_mutex);
+    frame_start = now;
+
+    if (now - last_report >= REPORT_INTERVAL_NS) {
+        telemetry_report();
+        last_report = now;
+    }
+}
+
+void telemetry_report() {
+    sample_summary summaries[NUM_PHASES];
+    thread_mutex_lock(&rings_mutex);
+    for (int i = 0; i < NUM_PHASES; i++) summaries[i] = sample_ring_summary(&rings[i]);
+    thread_mutex_unlock(&rings_mutex);
+
+    printf("%-14s %8s %8s %8s %8s  (ms)\n", "phase", "p50", "p95", "p99", "max");
+    for (int i = 0; i < NUM_PHASES; i++) {
+        sample_summary s = summaries[i];
+        printf("%-14s %8.3f %8.3f %8.3f %8.3f\n", phase_names[i],
+            s.p50 / 1e6, s.p95 / 1e6, s.p99 / 1e6, s.max / 1e6);
+    }
+    if (queries_skipped) printf("gpu queries skipped: %llu\n", queries_skipped);
+}
+
+// Reads back finished queries, oldest first, without ever waiting on one
+static void collect_gpu_queries() {
+    for (unsigned int n = 0; n < GPU_QUERY_LATENCY; n++) {
+        unsigned int slot = (query_next + n) % GPU_QUERY_LATENCY;
+        if (!query_pending[slot]) continue;
+
+        int available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+        sample_ring_push(&rings[PHASE_GPU], (uint64_t)elapsed);
+        query_pending[slot] = 0;
+    }
+}
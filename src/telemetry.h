@@ -0,0 +1,42 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+typedef enum {
+    PHASE_DRAW,
+    PHASE_POLL_EVENTS,
+    PHASE_SWAP_BUFFERS,
+    PHASE_FRAME,        // whole frame, start to start
+    PHASE_GPU,          // GPU time of draw(), from GL_TIME_ELAPSED queries
+    NUM_PHASES
+} telemetry_phase;
+
+/*
+* telemetry_init: Allocates the sample rings and the GL timer queries. Needs a current GL context, the GPU and
+* frame functions must then be called from that context's thread.
+*
+* @return 1 if successful, 0 otherwise
+*/
+int telemetry_init();
+void telemetry_cleanup();
+
+// CPU timing of a phase, begin/end pairs must not nest for the same phase. Each phase is timed from one thread
+void telemetry_begin(telemetry_phase phase);
+void telemetry_end(telemetry_phase phase);
+
+/*
+* telemetry_gpu_begin / telemetry_gpu_end: Brackets the GL commands to time on the GPU. The result is collected
+* a few frames later, once the query reports it is available, so reading it never stalls the pipeline.
+*/
+void telemetry_gpu_begin();
+void telemetry_gpu_end();
+
+/*
+* telemetry_end_frame: Records the frame time and collects any finished GPU queries. Call once per frame.
+* Prints a report every few seconds.
+*/
+void telemetry_end_frame();
+
+// Prints p50/p95/p99 for every phase over the recent sample window
+void telemetry_report();
+
+#endif // !TELEMETRY_H
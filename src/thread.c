@@ -0,0 +1,135 @@
+#include "thread.h"
+
+#ifdef _WIN32
+#include <stdlib.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// CreateThread wants a DWORD WINAPI function, so the pthread style one is called from here
+typedef struct {
+    void *(*fn)(void *);
+    void *arg;
+} thread_start;
+
+static DWORD WINAPI thread_trampoline(LPVOID param) {
+    thread_start start = *(thread_start *)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+
+int thread_create(thread_handle *thread, void *(*fn)(void *), void *arg) {
+    thread_start *start = malloc(sizeof(thread_start));
+    if (start == NULL) return 0;
+    start->fn = fn;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return 0;
+    }
+    return 1;
+}
+
+void thread_join(thread_handle thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void thread_mutex_init(thread_mutex *mutex) {
+    InitializeSRWLock(mutex);
+}
+
+// Slim reader/writer locks hold no resources
+void thread_mutex_destroy(thread_mutex *mutex) {
+    (void)mutex;
+}
+
+void thread_mutex_lock(thread_mutex *mutex) {
+    AcquireSRWLockExclusive(mutex);
+}
+
+void thread_mutex_unlock(thread_mutex *mutex) {
+    ReleaseSRWLockExclusive(mutex);
+}
+
+void thread_cond_init(thread_cond *cond) {
+    InitializeConditionVariable(cond);
+}
+
+void thread_cond_destroy(thread_cond *cond) {
+    (void)cond;
+}
+
+void thread_cond_wait(thread_cond *cond, thread_mutex *mutex) {
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+void thread_cond_signal(thread_cond *cond) {
+    WakeConditionVariable(cond);
+}
+
+void thread_cond_broadcast(thread_cond *cond) {
+    WakeAllConditionVariable(cond);
+}
+
+int thread_cpu_count() {
+    DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return (count > 0) ? (int)count : 1;
+}
+
+#else
+
+int thread_create(thread_handle *thread, void *(*fn)(void *), void *arg) {
+    return pthread_create(thread, NULL, fn, arg) == 0;
+}
+
+void thread_join(thread_handle thread) {
+    pthread_join(thread, NULL);
+}
+
+void thread_mutex_init(thread_mutex *mutex) {
+    pthread_mutex_init(mutex, NULL);
+}
+
+void thread_mutex_destroy(thread_mutex *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
+void thread_mutex_lock(thread_mutex *mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+void thread_mutex_unlock(thread_mutex *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+void thread_cond_init(thread_cond *cond) {
+    pthread_cond_init(cond, NULL);
+}
+
+void thread_cond_destroy(thread_cond *cond) {
+    pthread_cond_destroy(cond);
+}
+
+void thread_cond_wait(thread_cond *cond, thread_mutex *mutex) {
+    pthread_cond_wait(cond, mutex);
+}
+
+void thread_cond_signal(thread_cond *cond) {
+    pthread_cond_signal(cond);
+}
+
+void thread_cond_broadcast(thread_cond *cond) {
+    pthread_cond_broadcast(cond);
+}
+
+int thread_cpu_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#ifdef _WIN32
+// Every includer sees windows.h, keep it from defining min/max and pulling in the rest of the Win32 API
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Threads, mutexes and condition variables over pthreads, or the Win32 equivalents
+#ifdef _WIN32
+typedef HANDLE thread_handle;
+typedef SRWLOCK thread_mutex;
+typedef CONDITION_VARIABLE thread_cond;
+#define THREAD_MUTEX_INITIALIZER SRWLOCK_INIT
+#define THREAD_COND_INITIALIZER CONDITION_VARIABLE_INIT
+#else
+typedef pthread_t thread_handle;
+typedef pthread_mutex_t thread_mutex;
+typedef pthread_cond_t thread_cond;
+#define THREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define THREAD_COND_INITIALIZER PTHREAD_COND_INITIALIZER
+#endif
+
+/*
+* thread_create: Starts a thread running a function
+*
+* @param[out] thread: handle to join the thread with
+* @param[in] fn: function to run, its return value is discarded
+* @param[in] arg: argument passed to fn
+*
+* @return 1 if the thread started, 0 otherwise
+*/
+int thread_create(thread_handle *thread, void *(*fn)(void *), void *arg);
+
+// Waits for a thread to return and releases it
+void thread_join(thread_handle thread);
+
+void thread_mutex_init(thread_mutex *mutex);
+void thread_mutex_destroy(thread_mutex *mutex);
+void thread_mutex_lock(thread_mutex *mutex);
+void thread_mutex_unlock(thread_mutex *mutex);
+
+void thread_cond_init(thread_cond *cond);
+void thread_cond_destroy(thread_cond *cond);
+
+// Releases the mutex while waiting, holds it again on return. May wake spuriously, so wait in a loop
+void thread_cond_wait(thread_cond *cond, thread_mutex *mutex);
+void thread_cond_signal(thread_cond *cond);
+void thread_cond_broadcast(thread_cond *cond);
+
+// Logical processors available, at least 1
+int thread_cpu_count();
+
+#endif // !THREAD_H
@@ -0,0 +1,64 @@
+#include "timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+
+uint64_t timer_now_ns() {
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * NS_PER_SEC
+        + (uint64_t)(counter.QuadPart % frequency.QuadPart) * NS_PER_SEC / (uint64_t)frequency.QuadPart;
+}
+
+void timer_sleep_ns(uint64_t ns) {
+    Sleep((DWORD)(ns / NS_PER_MS));
+}
+
+static void cpu_relax() {
+    YieldProcessor();
+}
+
+#else
+
+uint64_t timer_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+void timer_sleep_ns(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / NS_PER_SEC), (long)(ns % NS_PER_SEC) };
+    // Resume after signal interruptions with whatever time is left, any other error would never clear
+    while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR));
+}
+
+static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#endif
+
+void timer_wait_until_ns(uint64_t deadline_ns, uint64_t spin_ns) {
+    uint64_t now = timer_now_ns();
+    if (now >= deadline_ns) return;
+
+    // Coarse phase: hand the core back to the OS while there is slack
+    if (deadline_ns - now > spin_ns) {
+        timer_sleep_ns(deadline_ns - now - spin_ns);
+    }
+
+    // Fine phase: spin the rest of the way
+    while (timer_now_ns() < deadline_ns) cpu_relax();
+}
@@ -0,0 +1,34 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+#define NS_PER_SEC 1000000000ULL
+#define NS_PER_MS 1000000ULL
+
+/*
+* timer_now_ns: Reads the monotonic wall clock. Unaffected by system time changes and, unlike clock(), counts
+* time spent sleeping or waiting on the GPU.
+*
+* @return Nanoseconds since an arbitrary fixed point in the past
+*/
+uint64_t timer_now_ns();
+
+/*
+* timer_sleep_ns: Suspends the calling thread for at least the given duration. May oversleep by the OS scheduler
+* granularity.
+*
+* @param[in] ns: how long to sleep for
+*/
+void timer_sleep_ns(uint64_t ns);
+
+/*
+* timer_wait_until_ns: Blocks until the monotonic clock reaches a deadline. Sleeps until spin_ns before the
+* deadline, then busy-waits the remainder so the wake-up lands on the deadline rather than a scheduler tick.
+*
+* @param[in] deadline_ns: absolute time (as returned by timer_now_ns) to wait for
+* @param[in] spin_ns: length of the busy-wait window before the deadline
+*/
+void timer_wait_until_ns(uint64_t deadline_ns, uint64_t spin_ns);
+
+#endif // !TIMER_H
@@ -0,0 +1,133 @@
+#include "transposition_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BUCKET_ENTRIES 4
+#define CACHE_LINE 64
+#define COUNTER_STRIPES 64
+
+// Set in every stored data word, so an empty slot (both words zero) never matches, not even key 0
+#define DATA_USED (1ull << 32)
+
+struct tt_slot {
+    _Atomic uint64_t key_xor_data;
+    _Atomic uint64_t data;
+};
+
+struct tt_counters {
+    atomic_uint_fast64_t probes;
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t collisions;
+    char padding[CACHE_LINE - 3 * sizeof(atomic_uint_fast64_t)];
+};
+
+static uint64_t pack(tt_entry entry) {
+    return DATA_USED | ((uint64_t)entry.flags << 24) | ((uint64_t)entry.move << 16) | ((uint64_t)entry.value << 8) | entry.depth;
+}
+
+static tt_entry unpack(uint64_t data) {
+    tt_entry entry = { (uint8_t)data, (uint8_t)(data >> 8), (uint8_t)(data >> 16), (uint8_t)(data >> 24) };
+    return entry;
+}
+
+// The low bits pick the bucket, so the stripe comes from the high ones
+static tt_counters *stripe(transposition_table *table, uint64_t key) {
+    return &table->counters[key >> 58];
+}
+
+int transposition_table_init(transposition_table *table, uint64_t min_entries) {
+    uint64_t buckets = 1;
+    while (buckets * BUCKET_ENTRIES < min_entries) buckets *= 2;
+
+    // Bucket and counter arrays both cache line aligned, carved from one allocation
+    size_t slots_size = (size_t)(buckets * BUCKET_ENTRIES * sizeof(tt_slot));
+    size_t counters_size = COUNTER_STRIPES * sizeof(tt_counters);
+    table->allocation = malloc(slots_size + counters_size + CACHE_LINE);
+    if (table->allocation == NULL) return 0;
+    uintptr_t aligned = ((uintptr_t)table->allocation + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+    table->slots = (tt_slot *)aligned;
+    table->counters = (tt_counters *)(aligned + slots_size);
+    table->bucket_mask = buckets - 1;
+    transposition_table_clear(table);
+    return 1;
+}
+
+void transposition_table_free(transposition_table *table) {
+    free(table->allocation);
+    table->allocation = NULL;
+    table->slots = NULL;
+    table->counters = NULL;
+}
+
+void transposition_table_clear(transposition_table *table) {
+    uint64_t num_slots = (table->bucket_mask + 1) * BUCKET_ENTRIES;
+    for (uint64_t i = 0; i < num_slots; i++) {
+        atomic_init(&table->slots[i].key_xor_data, 0);
+        atomic_init(&table->slots[i].data, 0);
+    }
+    for (int i = 0; i < COUNTER_STRIPES; i++) {
+        atomic_init(&table->counters[i].probes, 0);
+        atomic_init(&table->counters[i].hits, 0);
+        atomic_init(&table->counters[i].collisions, 0);
+    }
+}
+
+int transposition_table_probe(transposition_table *table, uint64_t key, tt_entry *entry) {
+    tt_slot *bucket = &table->slots[(key & table->bucket_mask) * BUCKET_ENTRIES];
+    tt_counters *counters = stripe(table, key);
+    atomic_fetch_add_explicit(&counters->probes, 1, memory_order_relaxed);
+
+    for (int i = 0; i < BUCKET_ENTRIES; i++) {
+        uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        uint64_t key_xor_data = atomic_load_explicit(&bucket[i].key_xor_data, memory_order_relaxed);
+        if ((data & DATA_USED) && ((key_xor_data ^ data) == key)) {
+            *entry = unpack(data);
+            atomic_fetch_add_explicit(&counters->hits, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void transposition_table_store(transposition_table *table, uint64_t key, tt_entry entry) {
+    tt_slot *bucket = &table->slots[(key & table->bucket_mask) * BUCKET_ENTRIES];
+    uint64_t data = pack(entry);
+
+    // The same key, else an empty slot, else the shallowest entry. Racing stores may both pick a slot; one wins
+    // and the bucket stays consistent, as every slot always holds one whole entry or a mismatch.
+    int victim = -1, evicts = 1;
+    unsigned int victim_depth = UINT32_MAX;
+    for (int i = 0; i < BUCKET_ENTRIES; i++) {
+        uint64_t old = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        uint64_t old_key = atomic_load_explicit(&bucket[i].key_xor_data, memory_order_relaxed) ^ old;
+        if ((old & DATA_USED) && (old_key == key)) {
+            if (unpack(old).depth > entry.depth) return;
+            victim = i;
+            evicts = 0;
+            break;
+        }
+        if (!(old & DATA_USED)) {
+            if (evicts) victim = i;
+            evicts = 0;
+        } else if (evicts && (unpack(old).depth < victim_depth)) {
+            victim = i;
+            victim_depth = unpack(old).depth;
+        }
+    }
+
+    atomic_store_explicit(&bucket[victim].key_xor_data, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&bucket[victim].data, data, memory_order_relaxed);
+    if (evicts) atomic_fetch_add_explicit(&stripe(table, key)->collisions, 1, memory_order_relaxed);
+}
+
+tt_stats transposition_table_stats(const transposition_table *table) {
+    tt_stats stats = { 0, 0, 0, 0 };
+    for (int i = 0; i < COUNTER_STRIPES; i++) {
+        stats.probes += atomic_load(&table->counters[i].probes);
+        stats.hits += atomic_load(&table->counters[i].hits);
+        stats.collisions += atomic_load(&table->counters[i].collisions);
+    }
+    stats.misses = stats.probes - stats.hits;
+    return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+* Fixed-size hash table of search results, shared by every thread of a search without locks. Entries are two
+* 64-bit words, the data and the key XORed with the data, each written with a single atomic store. A reader that
+* catches an entry half overwritten sees a key that doesn't match and treats it as a miss, so no entry is ever
+* read torn. Four entries share a 64-byte bucket; a store replaces the entry for the same key, an empty one, or
+* else the one searched least deep.
+*/
+typedef struct {
+    uint8_t depth;      // how deep the result was searched, deeper results are kept in preference
+    uint8_t value;
+    uint8_t move;
+    uint8_t flags;
+} tt_entry;
+
+typedef struct {
+    uint64_t probes;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t collisions;    // stores that evicted a different state
+} tt_stats;
+
+typedef struct tt_slot tt_slot;
+typedef struct tt_counters tt_counters;
+
+typedef struct {
+    tt_slot *slots;
+    uint64_t bucket_mask;
+    void *allocation;
+    tt_counters *counters;      // striped so threads rarely update the same cache line
+} transposition_table;
+
+/*
+* transposition_table_init: Allocates an empty table
+*
+* @param[out] table: table to initialize
+* @param[in] min_entries: capacity, rounded up to a power of two of at least one bucket
+*
+* @return 1 if successful, 0 if out of memory
+*/
+int transposition_table_init(transposition_table *table, uint64_t min_entries);
+
+void transposition_table_free(transposition_table *table);
+
+// Empties the table and zeroes the counters, not safe while other threads use it
+void transposition_table_clear(transposition_table *table);
+
+/*
+* transposition_table_probe: Looks up a key
+*
+* @param[in] table: table to search
+* @param[in] key: 64-bit hash of the state, cube_state_hash or any hash as good
+* @param[out] entry: the stored result, if found
+*
+* @return 1 if the key was found, 0 otherwise
+*/
+int transposition_table_probe(transposition_table *table, uint64_t key, tt_entry *entry);
+
+// Stores a result, unless the key is already held with a deeper one
+void transposition_table_store(transposition_table *table, uint64_t key, tt_entry entry);
+
+// Sums the counters; exact once the threads using the table have finished
+tt_stats transposition_table_stats(const transposition_table *table);
+
+#endif // !TRANSPOSITION_TABLE_H
@@ -0,0 +1,48 @@
+#ifndef TWO_PHASE_H
+#define TWO_PHASE_H
+
+#include <stdint.h>
+
+#include "cube_state.h"
+
+// Longest max_length accepted, the move array must have room for this plus two leading rotations
+#define TWO_PHASE_MAX_LENGTH 30
+#define TWO_PHASE_MAX_MOVES (TWO_PHASE_MAX_LENGTH + 2)
+
+/*
+* Kociemba's two-phase algorithm. Phase 1 searches face turns until corner twist, edge flip and the slice edges'
+* positions are solved, which puts the cube in the subgroup generated by U, D, R2, L2, F2 and B2. Phase 2 then
+* solves corner, edge and slice permutation with those moves only. Both phases are IDA* over coordinate move
+* tables, pruned by the largest of several precomputed distance tables.
+*/
+
+/*
+* two_phase_init: Builds the move and pruning tables (about 5 MB, around a second on one core), call once before
+* solving
+*
+* @param[in] table_dir: directory to map the pruning tables from, writing them there if missing, so processes
+*     share one copy. NULL to build them in memory.
+*
+* @return 1 if successful, 0 if a table couldn't be loaded or allocated
+*/
+int two_phase_init(const char *table_dir);
+
+/*
+* two_phase_solve: Finds a face turn sequence that solves a cube state. If the centres are not at home the
+* solution starts with up to two rotations bringing them there, which don't count towards max_length. After a
+* solution is found the search goes on under a tighter bound, and the shortest one found is returned. Without a time
+* budget that stops with the phase 1 depth the first solution came from. With one, deeper phase 1s are tried too,
+* until the budget runs out or none can lead to a shorter solution.
+*
+* @param[in] state: cube to solve, cube_state_is_valid must hold
+* @param[in] max_length: longest acceptable solution in face turns, at most TWO_PHASE_MAX_LENGTH. 22 takes a few
+*     milliseconds, 21 a few tens, 20 can take much longer.
+* @param[in] time_budget_ns: stop after this long, 0 for no limit
+* @param[out] moves: solution, room for TWO_PHASE_MAX_MOVES
+*
+* @return Number of moves, -1 if the state is invalid, two_phase_init hasn't succeeded or no solution was found within
+*     the limits
+*/
+int two_phase_solve(const cube_state *state, int max_length, uint64_t time_budget_ns, uint8_t *moves);
+
+#endif // !TWO_PHASE_H
@@ -15,6 +15,7 @@ static int wheight = 600;
 // Forward declarations
 static void window_error_callback(int error_code, const char *description);
 static void framebuffer_size_callback(GLFWwindow *window, int width, int height);
+static int create_hidden_window(int platform, int context_api);
 
 int window_init() {
     glfwSetErrorCallback(window_error_callback);
@@ -31,7 +32,7 @@ int window_init() {
         return 0;
     }
 
-    glfwMakeContextCurrent(window);
+    glfwGetFramebufferSize(window, &wwidth, &wheight);
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
@@ -40,6 +41,23 @@ int window_init() {
     return 1;
 }
 
+int window_init_headless(int width, int height) {
+    glfwSetErrorCallback(window_error_callback);
+    wwidth = width; wheight = height;
+
+#ifdef GLFW_PLATFORM_NULL
+    // Without a display server: GLFW's null platform with a surfaceless EGL context (Mesa), else OSMesa
+    if (create_hidden_window(GLFW_PLATFORM_NULL, GLFW_EGL_CONTEXT_API)) return 1;
+    if (create_hidden_window(GLFW_PLATFORM_NULL, GLFW_OSMESA_CONTEXT_API)) return 1;
+    if (create_hidden_window(GLFW_ANY_PLATFORM, GLFW_NATIVE_CONTEXT_API)) return 1;
+#else
+    if (create_hidden_window(0, GLFW_NATIVE_CONTEXT_API)) return 1;
+#endif
+
+    printf("Unable to create a headless GL context\n");
+    return 0;
+}
+
 void window_cleanup() {
     glfwTerminate();
 }
@@ -56,6 +74,25 @@ int window_height() {
     return wheight;
 }
 
+void window_acquire_context() {
+    glfwMakeContextCurrent(window);
+}
+
+void window_release_context() {
+    glfwMakeContextCurrent(NULL);
+}
+
+void window_set_vsync(int enabled) {
+    glfwSwapInterval(enabled ? 1 : 0);
+}
+
+int window_refresh_rate() {
+    GLFWmonitor *monitor = glfwGetWindowMonitor(window);
+    if (monitor == NULL) monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode *mode = monitor ? glfwGetVideoMode(monitor) : NULL;
+    return mode ? mode->refreshRate : 0;
+}
+
 void poll_events() {
     glfwPollEvents();
 }
@@ -66,11 +103,34 @@ void swap_buffers() {
 
 // Forward declaration definitions
 
+static int create_hidden_window(int platform, int context_api) {
+#ifdef GLFW_PLATFORM_NULL
+    glfwInitHint(GLFW_PLATFORM, platform);
+#endif
+    if (!glfwInit()) return 0;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, context_api);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // Rendering goes to an offscreen framebuffer, the window only carries the context
+    window = glfwCreateWindow(wwidth, wheight, "rubix-cube-gl", NULL, NULL);
+    if (!window) {
+        glfwTerminate();
+        return 0;
+    }
+
+    glfwMakeContextCurrent(window);
+    return 1;
+}
+
 void window_error_callback(int error_code, const char *description) {
     printf("GLFW Error %d: %s\n", error_code, description);
 }
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
+    // No GL calls here, the context belongs to the render thread. It picks the size up from the next snapshot
     wwidth = width; wheight = height;
-    glViewport(0, 0, wwidth, wheight);
 }
\ No newline at end of file
@@ -2,11 +2,32 @@
 #define WINDOW_H
 
 int window_init();
+
+/*
+* window_init_headless: Creates an invisible window whose only purpose is to own a GL context, for rendering into
+* offscreen framebuffers. Works without a display server where GLFW and the driver allow it (e.g. Mesa llvmpipe
+* through EGL). The context is current on the calling thread.
+*
+* @param[in] width, height: size reported by window_width / window_height
+*
+* @return 1 if successful, 0 otherwise
+*/
+int window_init_headless(int width, int height);
 void window_cleanup();
 int window_should_close();
 int window_width();
 int window_height();
 
+// Makes the window's GL context current on the calling thread. A context is current on at most one thread.
+void window_acquire_context();
+void window_release_context();
+
+// Needs the context to be current on the calling thread
+void window_set_vsync(int enabled);
+
+// Refresh rate of the monitor showing the window (the primary one for a windowed window), 0 if unknown. Main thread only
+int window_refresh_rate();
+
 void poll_events();
 void swap_buffers();
 